@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <string>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertoscpp/freertos.hpp"
+#include "freertoscpp/freertos_task_factory.hpp"
+#include "freertoscpp/queue.hpp"
+#include "freertoscpp/pooled_queue.hpp"
+
+// Compares the pointer-boxing queue<T> with pooled_queue<T, N>, for a trivially
+// copyable message and for one with a std::string member.
+//
+// For each run a consumer task on the other core drains MESSAGES messages while the
+// producer keeps one small long-lived allocation every KEEP_EVERY messages, the way
+// other subsystems allocate while the queue is busy. With queue<T> every message is
+// a new/delete, so the boxes end up interleaved with the kept blocks; the free-block
+// count and largest free block, taken before the kept blocks are released, show the
+// fragmentation left behind.
+
+using augtons::freertos::pooled_queue;
+using augtons::freertos::queue;
+using augtons::freertos::task_builder;
+
+static const char* TAG = "queue_benchmark";
+
+static constexpr size_t LENGTH = 16;
+static constexpr int MESSAGES = 20000;
+static constexpr int KEEP_EVERY = 100;
+static constexpr size_t KEEP_SIZE = 48;
+
+struct Sample {            // Trivially copyable: a rain gauge reading
+    uint32_t timestamp_ms;
+    uint16_t tips;
+    uint16_t boot;
+    float fields[6];
+};
+
+struct Message {           // Not trivially copyable (fits the std::string SSO)
+    std::string text;
+    int seq = 0;
+};
+
+static Sample make_sample(int i) {
+    return Sample{(uint32_t)i, (uint16_t)i, 1, {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f}};
+}
+
+static Message make_message(int i) {
+    return Message{"tip", i};
+}
+
+struct HeapSnapshot {
+    size_t free_bytes;
+    size_t free_blocks;
+    size_t allocated_blocks;
+    size_t largest_free_block;
+};
+
+static HeapSnapshot snapshot() {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    return {info.total_free_bytes, info.free_blocks, info.allocated_blocks, info.largest_free_block};
+}
+
+template<typename Queue, typename Make>
+static void run(const char* name, Queue& q, Make make) {
+    static void* kept[MESSAGES / KEEP_EVERY];
+    TaskHandle_t producer = xTaskGetCurrentTaskHandle();
+
+    auto consumer = task_builder<>("consumer").stack(4096).priority(5).core_id(1).bind([&q, producer] {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Start together with the producer
+        for (int i = 0; i < MESSAGES; i++) {
+            q.receive();
+        }
+        xTaskNotifyGive(producer);
+    });
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    HeapSnapshot before = snapshot();
+    int64_t start_us = esp_timer_get_time();
+    xTaskNotifyGive(consumer.native_handle());
+
+    size_t n_kept = 0;
+    for (int i = 0; i < MESSAGES; i++) {
+        q.send(make(i));
+        if (i % KEEP_EVERY == 0) {
+            kept[n_kept++] = malloc(KEEP_SIZE);
+        }
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    HeapSnapshot after = snapshot();
+    for (size_t i = 0; i < n_kept; i++) {
+        free(kept[i]);
+    }
+
+    ESP_LOGI(TAG, "%-24s %8lld msg/s | free blocks %u -> %u | largest free %u -> %u | fragmentation %.1f%% -> %.1f%%",
+             name, (long long)MESSAGES * 1000000 / elapsed_us,
+             (unsigned)before.free_blocks, (unsigned)after.free_blocks,
+             (unsigned)before.largest_free_block, (unsigned)after.largest_free_block,
+             100.0 * (1.0 - (double)before.largest_free_block / before.free_bytes),
+             100.0 * (1.0 - (double)after.largest_free_block / after.free_bytes));
+    vTaskDelay(pdMS_TO_TICKS(100));  // Let the idle task free the consumer's stack
+}
+
+extern "C" void app_main()
+{
+    vTaskPrioritySet(nullptr, 5);
+
+    {
+        auto q = queue<Sample>::with_depth(LENGTH);
+        q.footprint().report("queue<Sample>");
+        run("queue<Sample>", q, make_sample);
+    }
+    {
+        static pooled_queue<Sample, LENGTH> q;
+        q.footprint().report("pooled_queue<Sample>");
+        run("pooled_queue<Sample>", q, make_sample);
+    }
+    {
+        auto q = queue<Message>::with_depth(LENGTH);
+        q.footprint().report("queue<Message>");
+        run("queue<Message>", q, make_message);
+    }
+    {
+        static pooled_queue<Message, LENGTH> q;
+        q.footprint().report("pooled_queue<Message>");
+        run("pooled_queue<Message>", q, make_message);
+    }
+}
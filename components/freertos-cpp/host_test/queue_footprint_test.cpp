@@ -0,0 +1,100 @@
+// Checks the sizing API of queue<T> and pooled_queue<T, N> on the host:
+//  - queue<T>(depth) creates a FreeRTOS queue of `depth` pointer-sized items (the
+//    constructor used to pass the two sizes to xQueueCreate the other way round);
+//  - footprint() reports storage, control block and message slots for several depths,
+//    and for pooled_queue it accounts for the whole object.
+//
+// Usage: queue_footprint_test
+
+#include <cstdio>
+#include <string>
+
+#include "freertos/queue.h"
+#include "freertoscpp/queue.hpp"
+#include "freertoscpp/pooled_queue.hpp"
+
+using augtons::freertos::pooled_queue;
+using augtons::freertos::queue;
+using augtons::freertos::queue_footprint;
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+struct Reading {
+    uint32_t tips;
+    int64_t time_us;
+    char label[20];
+};
+
+static void check_queue(size_t depth) {
+    auto q = queue<Reading>::with_depth(depth);
+    CHECK(!q.is_null());
+    CHECK(q.depth() == depth);
+    CHECK(q.native_handle()->length == depth);
+    CHECK(q.native_handle()->item_size == sizeof(Reading*));
+
+    // Holds exactly `depth` messages
+    for (size_t i = 0; i < depth; i++) {
+        CHECK(q.send(Reading{(uint32_t)i, 0, "x"}, 0) == pdPASS);
+    }
+    CHECK(q.send(Reading{0, 0, "full"}, 0) != pdPASS);
+    for (size_t i = 0; i < depth; i++) {
+        auto r = q.receive(0);
+        CHECK(r.has_value() && r->tips == i);
+    }
+
+    queue_footprint f = q.footprint();
+    CHECK(f.depth == depth);
+    CHECK(f.item_size == sizeof(Reading*));
+    CHECK(f.storage_bytes == depth * sizeof(Reading*));
+    CHECK(f.pool_bytes == depth * sizeof(Reading));
+    CHECK(f.pool_on_heap);
+    CHECK(f.control_bytes >= sizeof(StaticQueue_t));
+    CHECK(f.total() == f.storage_bytes + f.control_bytes + f.pool_bytes);
+    f.report("queue<Reading>");
+}
+
+template<typename T, size_t N>
+static void check_pooled(const char* name, size_t item_size, size_t slot_bytes) {
+    constexpr queue_footprint f = pooled_queue<T, N>::footprint();
+    static_assert(f.depth == N, "depth");
+    CHECK(f.item_size == item_size);
+    CHECK(f.pool_bytes == slot_bytes * N);
+    CHECK(!f.pool_on_heap);
+    // Everything lives in the object; what is left is handles and alignment padding
+    CHECK(f.total() <= sizeof(pooled_queue<T, N>));
+    CHECK(sizeof(pooled_queue<T, N>) - f.total() <= 4 * sizeof(void*) + alignof(T));
+
+    pooled_queue<T, N> q;
+    CHECK(q.native_handle()->length == N);
+    CHECK(q.native_handle()->item_size == item_size);
+    f.report(name);
+}
+
+int main() {
+    for (size_t depth : {1, 4, 8, 32, 100, 1000}) {
+        check_queue(depth);
+    }
+    // The footprint grows linearly with the depth
+    CHECK(queue<Reading>::footprint_for(1000).total() - queue<Reading>::footprint_for(100).total()
+          == 900 * (sizeof(Reading*) + sizeof(Reading)));
+
+    check_pooled<uint32_t, 1>("pooled_queue<uint32_t, 1>", sizeof(uint32_t), 0);
+    check_pooled<uint32_t, 32>("pooled_queue<uint32_t, 32>", sizeof(uint32_t), 0);
+    check_pooled<Reading, 16>("pooled_queue<Reading, 16>", sizeof(Reading), 0);
+    check_pooled<std::string, 4>("pooled_queue<std::string, 4>", sizeof(std::string*), sizeof(std::string));
+    check_pooled<std::string, 64>("pooled_queue<std::string, 64>", sizeof(std::string*), sizeof(std::string));
+
+    if (failures != 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("all footprint checks passed\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Compares spsc_ring<T, N>::push_from_isr with the semantics of xQueueSendFromISR
+// (critical section and copy per item, wake the blocked receiver) on the host.
+//
+// Two runs per implementation, with the consumer on its own thread:
+//  - latency: the producer sends one item and waits ~20 us before the next, as
+//    sparse tips would; the time from send to receive is measured per item;
+//  - throughput: the producer sends as fast as it can.
+// Both report the mean time spent inside the send call, which is what the ISR pays,
+// and check that every item arrives once and in order.
+//
+// Usage: spsc_ring_bench [items]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "freertos/queue.h"
+#include "freertoscpp/spsc_ring.hpp"
+
+using augtons::freertos::spsc_ring;
+using clock_type = std::chrono::steady_clock;
+
+static constexpr size_t RING_SIZE = 32;
+
+struct Item {
+    uint32_t seq;
+    int64_t sent_ns;
+};
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now().time_since_epoch()).count();
+}
+
+static void spin_for_ns(int64_t ns) {
+    int64_t until = now_ns() + ns;
+    while (now_ns() < until) {
+    }
+}
+
+class QueueChannel {
+    QueueHandle_t q = xQueueCreate(RING_SIZE, sizeof(Item));
+public:
+    ~QueueChannel() { vQueueDelete(q); }
+    void attach_consumer() {}
+    bool send(const Item& item) {
+        BaseType_t woken = pdFALSE;
+        return xQueueSendFromISR(q, &item, &woken) == pdPASS;
+    }
+    bool receive(Item& item) { return xQueueReceive(q, &item, pdMS_TO_TICKS(1000)) == pdTRUE; }
+};
+
+class RingChannel {
+    spsc_ring<Item, RING_SIZE> ring;
+public:
+    void attach_consumer() { ring.attach_consumer(); }
+    bool send(const Item& item) {
+        BaseType_t woken = pdFALSE;
+        return ring.push_from_isr(item, &woken);
+    }
+    bool receive(Item& item) { return ring.pop(item, pdMS_TO_TICKS(1000)); }
+};
+
+struct Result {
+    double items_per_s;
+    double send_ns;
+    int64_t p50_ns;
+    int64_t p99_ns;
+    int64_t max_ns;
+    bool ok;
+};
+
+template<typename Channel>
+static Result run(uint32_t items, int64_t gap_ns) {
+    Channel channel;
+    std::vector<int64_t> latency(items);
+    std::atomic<bool> ready{false};
+    bool ok = true;
+
+    std::thread consumer([&] {
+        channel.attach_consumer();
+        ready = true;
+        Item item;
+        for (uint32_t i = 0; i < items; i++) {
+            if (!channel.receive(item) || item.seq != i) {
+                ok = false;
+                return;
+            }
+            latency[i] = now_ns() - item.sent_ns;
+        }
+    });
+    while (!ready) {
+    }
+
+    int64_t start = now_ns();
+    int64_t in_send_ns = 0;
+    uint32_t sends = 0;
+    for (uint32_t i = 0; i < items; i++) {
+        Item item{i, now_ns()};
+        bool sent;
+        do {
+            int64_t before = now_ns();
+            sent = channel.send(item);
+            in_send_ns += now_ns() - before;
+            sends++;
+        } while (!sent);  // Full: the real ISR would drop the item; here retry
+        if (gap_ns > 0) {
+            spin_for_ns(gap_ns);
+        }
+    }
+    consumer.join();
+    double elapsed_s = (now_ns() - start) / 1e9;
+
+    std::sort(latency.begin(), latency.end());
+    return {items / elapsed_s, (double)in_send_ns / sends, latency[items / 2], latency[items * 99 / 100], latency[items - 1], ok};
+}
+
+static bool report(const char* name, const Result& r) {
+    std::printf("%-28s %10.0f items/s   send %6.0f ns   latency p50 %7lld ns  p99 %8lld ns  max %9lld ns   %s\n",
+                name, r.items_per_s, r.send_ns, (long long)r.p50_ns, (long long)r.p99_ns, (long long)r.max_ns,
+                r.ok ? "ok" : "LOST OR REORDERED");
+    return r.ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t items = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 200000;
+    bool ok = true;
+
+    std::printf("Latency, one item every ~20 us (%u items)\n", (unsigned)items);
+    ok &= report("xQueueSendFromISR semantics", run<QueueChannel>(items, 20000));
+    ok &= report("spsc_ring::push_from_isr", run<RingChannel>(items, 20000));
+
+    std::printf("Throughput, back to back (%u items)\n", (unsigned)items);
+    ok &= report("xQueueSendFromISR semantics", run<QueueChannel>(items, 0));
+    ok &= report("spsc_ring::push_from_isr", run<RingChannel>(items, 0));
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
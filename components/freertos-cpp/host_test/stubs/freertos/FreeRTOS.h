@@ -0,0 +1,30 @@
+// Host stand-in for the parts of FreeRTOS used by the freertos-cpp headers. Tasks are
+// std::threads; notifications and queues are built on a mutex and a condition
+// variable, which plays the role of the kernel critical section and scheduler.
+#pragma once
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define tskNO_AFFINITY 0x7fffffff
+#define configMINIMAL_STACK_SIZE 768
+#define CONFIG_FREERTOS_MAX_TASK_NAME_LEN 16
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))  // 1 ms tick
+
+inline TickType_t xTaskGetTickCount() {
+    using namespace std::chrono;
+    static const auto start = steady_clock::now();
+    return (TickType_t)duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
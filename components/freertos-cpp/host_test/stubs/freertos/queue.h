@@ -0,0 +1,79 @@
+#pragma once
+#include <cstring>
+#include <vector>
+#include "freertos/task.h"
+
+// Copy-in/copy-out queue with the semantics of xQueueSendFromISR/xQueueReceive:
+// every call enters the critical section, and a send wakes a blocked receiver.
+struct host_queue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<uint8_t> storage;
+    size_t item_size;
+    size_t length;
+    size_t head = 0;
+    size_t used = 0;
+};
+typedef host_queue* QueueHandle_t;
+
+// Stand-in for the kernel control block, about the size of the ESP32 one
+struct StaticQueue_t {
+    uint32_t words[20];
+};
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    auto* q = new host_queue;
+    q->storage.resize(length * item_size);
+    q->item_size = item_size;
+    q->length = length;
+    return q;
+}
+
+// The host queue keeps its own storage; the caller's buffers are not used
+inline QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t*, StaticQueue_t*) {
+    return xQueueCreate(length, item_size);
+}
+
+inline void vQueueDelete(QueueHandle_t q) {
+    delete q;
+}
+
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken) {
+    {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        if (q->used == q->length) {
+            return errQUEUE_FULL;
+        }
+        size_t pos = (q->head + q->used) % q->length;
+        std::memcpy(&q->storage[pos * q->item_size], item, q->item_size);
+        q->used++;
+    }
+    q->cv.notify_one();
+    if (woken != nullptr) {
+        *woken = pdTRUE;
+    }
+    return pdPASS;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t) {
+    return xQueueSendFromISR(q, item, nullptr);
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t timeout) {
+    std::unique_lock<std::mutex> lock(q->mutex);
+    auto ready = [q] { return q->used > 0; };
+    if (timeout == portMAX_DELAY) {
+        q->cv.wait(lock, ready);
+    } else if (!q->cv.wait_for(lock, std::chrono::milliseconds(timeout), ready)) {
+        return pdFALSE;
+    }
+    std::memcpy(item, &q->storage[q->head * q->item_size], q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->used--;
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->mutex);
+    return q->used;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include "freertos/FreeRTOS.h"
+
+struct host_task {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notified = 0;
+};
+typedef host_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    thread_local host_task self;
+    return &self;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notified++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken != nullptr) {
+        *woken = pdTRUE;
+    }
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout) {
+    host_task* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto ready = [task] { return task->notified > 0; };
+    if (timeout == portMAX_DELAY) {
+        task->cv.wait(lock, ready);
+    } else {
+        task->cv.wait_for(lock, std::chrono::milliseconds(timeout), ready);
+    }
+    uint32_t value = task->notified;
+    if (value > 0) {
+        task->notified = clear ? 0 : value - 1;
+    }
+    return value;
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
@@ -0,0 +1,49 @@
+#ifndef FREERTOS_CPP_ALLOC_SCOPE_HPP
+#define FREERTOS_CPP_ALLOC_SCOPE_HPP
+
+// Allocation accounting hook. The heap allocations made by the library (the message
+// boxes of queue<T>, the shared control block and the TCB/stack of task<>) happen
+// inside an alloc_scope naming their kind. With CONFIG_FREERTOS_CPP_ALLOC_HOOKS the
+// application provides the two C functions below, e.g. to tag the allocations of the
+// calling task; otherwise the scope compiles to nothing.
+
+namespace augtons {
+    namespace freertos {
+        enum class alloc_kind : int {
+            queue = 0,
+            task = 1,
+        };
+    }
+}
+
+#if CONFIG_FREERTOS_CPP_ALLOC_HOOKS
+extern "C" {
+    // Returns a token that is passed back to freertos_cpp_alloc_exit()
+    int freertos_cpp_alloc_enter(int kind);
+    void freertos_cpp_alloc_exit(int token);
+}
+
+namespace augtons {
+    namespace freertos {
+        class alloc_scope {
+            int token;
+        public:
+            explicit alloc_scope(alloc_kind kind) : token(freertos_cpp_alloc_enter(static_cast<int>(kind))) {}
+            ~alloc_scope() { freertos_cpp_alloc_exit(token); }
+            alloc_scope(const alloc_scope&) = delete;
+            alloc_scope& operator=(const alloc_scope&) = delete;
+        };
+    }
+}
+#else
+namespace augtons {
+    namespace freertos {
+        class alloc_scope {
+        public:
+            explicit alloc_scope(alloc_kind) {}
+        };
+    }
+}
+#endif
+
+#endif //FREERTOS_CPP_ALLOC_SCOPE_HPP
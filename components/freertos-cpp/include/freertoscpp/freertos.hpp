@@ -5,6 +5,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos_types.hpp"
+#include "alloc_scope.hpp"
 
 namespace augtons {
     namespace freertos {
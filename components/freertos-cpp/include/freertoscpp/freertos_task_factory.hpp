@@ -27,7 +27,7 @@ public:
         const Func& func,
         BaseType_t core_id = tskNO_AFFINITY
     ) -> task<ArgType> {
-
+        alloc_scope scope(alloc_kind::task);
         auto data = std::make_shared<task_shared_data<ArgType>>(func, std::forward<InArgType<ArgType>>(task_args));
         auto ret = task<ArgType>(data);
 
@@ -63,6 +63,7 @@ public:
         const Func& func,
         BaseType_t core_id = tskNO_AFFINITY
     ) -> task<> {
+        alloc_scope scope(alloc_kind::task);
         auto data = std::make_shared<task_shared_data<>>(func);
         auto ret = task<>(data);
         if (xTaskCreatePinnedToCore(task_fun, name, stack_size, ret.shared_data.get(),
@@ -104,6 +105,10 @@ public:
     task<> bind(const Func& func) {
         return task_factory<>::create(m_name, m_stack_size_num, m_priority, func, m_core_id);
     }
+
+    // Statically allocated task; defined in static_task.hpp
+    template<uint32_t StackSize>
+    TaskHandle_t bind(static_task<StackSize>& storage, TaskFunction_t func, void *arg = nullptr);
 };
 
 template<typename ArgType>
@@ -1,6 +1,8 @@
 #ifndef FREERTOS_CPP_TYPES_HPP
 #define FREERTOS_CPP_TYPES_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include "esp_log.h"
 
@@ -28,6 +30,9 @@ namespace augtons
         template<typename ArgType = void>
         class task_builder;
 
+        template<uint32_t StackSize>
+        class static_task;
+
     }
 
     namespace freertos {
@@ -67,6 +72,12 @@ namespace augtons {
     namespace freertos {
         template<typename T>
         class queue;
+
+        template<typename T, size_t Length, typename Enable = void>
+        class pooled_queue;
+
+        template<typename T, size_t N>
+        class spsc_ring;
     }
 }
 
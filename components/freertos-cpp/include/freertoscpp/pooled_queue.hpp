@@ -0,0 +1,236 @@
+#ifndef FREERTOS_CPP_POOLED_QUEUE_HPP
+#define FREERTOS_CPP_POOLED_QUEUE_HPP
+
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "freertos.hpp"
+#include "freertos/queue.h"
+#include "queue_sizing.hpp"
+
+// Queue with no heap allocation at all. The FreeRTOS queues are created with
+// xQueueCreateStatic over buffers inside the object, and send/receive never call
+// new/delete:
+//  - trivially copyable T is copied by value into the FreeRTOS queue storage;
+//  - any other T is constructed in one of Length slots kept inside the object, and
+//    the FreeRTOS queue only carries the slot pointer.
+// Unlike queue<T>, it is neither copyable nor movable (the storage lives inside it);
+// share it by reference or make it static, which puts its whole footprint in .bss.
+
+template<typename T, size_t Length>
+class augtons::freertos::pooled_queue<T, Length, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+    static_assert(Length > 0, "Length must be greater than zero.");
+private:
+    StaticQueue_t queue_buffer;
+    uint8_t storage[Length * sizeof(T)];
+    QueueHandle_t handle = nullptr;
+public:
+    pooled_queue() {
+        handle = xQueueCreateStatic(Length, sizeof(T), storage, &queue_buffer);
+    }
+
+    // Everything is inside the object: the footprint is known at compile time
+    static constexpr queue_footprint footprint() {
+        return queue_footprint_of<T>(Length);
+    }
+
+    pooled_queue(const pooled_queue&) = delete;
+    pooled_queue& operator=(const pooled_queue&) = delete;
+
+    ~pooled_queue() {
+        if (handle != nullptr) {
+            vQueueDelete(handle);
+        }
+    }
+
+    static constexpr size_t capacity() {
+        return Length;
+    }
+
+    inline bool is_null() const {
+        return handle == nullptr;
+    }
+
+    QueueHandle_t native_handle() const {
+        return handle;
+    }
+
+    inline explicit operator QueueHandle_t() const {
+        return native_handle();
+    }
+
+    UBaseType_t size() const {
+        return is_null() ? 0 : uxQueueMessagesWaiting(handle);
+    }
+
+    BaseType_t send(const T& data, TickType_t timeout = portMAX_DELAY) const {
+        if (is_null()) {
+            return pdFAIL;
+        }
+        return xQueueSend(handle, &data, timeout);
+    }
+
+    BaseType_t send_from_isr(const T& data, BaseType_t* higher_priority_task_woken) const {
+        return xQueueSendFromISR(handle, &data, higher_priority_task_woken);
+    }
+
+    bool receive_to(T& out, TickType_t timeout = portMAX_DELAY) const {
+        if (is_null()) {
+            return false;
+        }
+        return xQueueReceive(handle, &out, timeout) == pdTRUE;
+    }
+
+    std::optional<T> receive(TickType_t timeout = portMAX_DELAY) const {
+        if (is_null()) {
+            return std::nullopt;
+        }
+        // T may have no default constructor; being trivially copyable, the bytes are the object
+        alignas(T) unsigned char buffer[sizeof(T)];
+        if (xQueueReceive(handle, buffer, timeout) != pdTRUE) {
+            return std::nullopt;
+        }
+        return *std::launder(reinterpret_cast<T*>(buffer));
+    }
+};
+
+template<typename T, size_t Length, typename Enable>
+class augtons::freertos::pooled_queue {
+    static_assert(Length > 0, "Length must be greater than zero.");
+    static_assert(!std::is_reference<T>::value, "Don't support reference type.");
+private:
+    alignas(T) unsigned char slots[Length][sizeof(T)];
+    StaticQueue_t queue_buffer;
+    StaticQueue_t free_slots_buffer;
+    uint8_t queue_storage[Length * sizeof(T*)];
+    uint8_t free_slots_storage[Length * sizeof(void*)];
+    QueueHandle_t handle = nullptr;      // Slots holding a message, in FIFO order
+    QueueHandle_t free_slots = nullptr;  // Slots available to send()
+
+    template<typename U>
+    BaseType_t emplace(U&& data, TickType_t timeout) {
+        if (is_null()) {
+            return pdFAIL;
+        }
+        // Waiting for a free slot is the same as waiting for room in the queue
+        void* slot = nullptr;
+        if (xQueueReceive(free_slots, &slot, timeout) != pdTRUE) {
+            return errQUEUE_FULL;
+        }
+        T* item = new (slot) T(std::forward<U>(data));
+        // Never blocks: there are as many places in the queue as slots
+        return xQueueSend(handle, &item, 0);
+    }
+
+    T* take(TickType_t timeout) const {
+        if (is_null()) {
+            return nullptr;
+        }
+        T* item = nullptr;
+        if (xQueueReceive(handle, &item, timeout) != pdTRUE) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    void release(T* item) const {
+        item->~T();
+        xQueueSend(free_slots, &item, 0);
+    }
+
+    void destroy() {
+        if (handle != nullptr) {
+            T* item = nullptr;
+            while (xQueueReceive(handle, &item, 0) == pdTRUE) {
+                item->~T();
+            }
+            vQueueDelete(handle);
+            handle = nullptr;
+        }
+        if (free_slots != nullptr) {
+            vQueueDelete(free_slots);
+            free_slots = nullptr;
+        }
+    }
+public:
+    pooled_queue() {
+        handle = xQueueCreateStatic(Length, sizeof(T*), queue_storage, &queue_buffer);
+        free_slots = xQueueCreateStatic(Length, sizeof(void*), free_slots_storage, &free_slots_buffer);
+        if (handle == nullptr || free_slots == nullptr) {
+            FreeRTOSCpp_LogE("Failed to create the queues of a pooled_queue.");
+            destroy();
+            return;
+        }
+        for (size_t i = 0; i < Length; i++) {
+            void* slot = slots[i];
+            xQueueSend(free_slots, &slot, 0);
+        }
+    }
+
+    // Pointer queue and free-slot queue, plus the slots themselves, all inside the object
+    static constexpr queue_footprint footprint() {
+        queue_footprint f = queue_footprint_of<T*>(Length);
+        f.storage_bytes += Length * sizeof(void*);
+        f.control_bytes *= 2;
+        f.pool_bytes = Length * sizeof(T);
+        return f;
+    }
+
+    pooled_queue(const pooled_queue&) = delete;
+    pooled_queue& operator=(const pooled_queue&) = delete;
+
+    ~pooled_queue() {
+        destroy();
+    }
+
+    static constexpr size_t capacity() {
+        return Length;
+    }
+
+    inline bool is_null() const {
+        return handle == nullptr || free_slots == nullptr;
+    }
+
+    QueueHandle_t native_handle() const {
+        return handle;
+    }
+
+    inline explicit operator QueueHandle_t() const {
+        return native_handle();
+    }
+
+    UBaseType_t size() const {
+        return is_null() ? 0 : uxQueueMessagesWaiting(handle);
+    }
+
+    BaseType_t send(T&& data, TickType_t timeout = portMAX_DELAY) {
+        return emplace(std::move(data), timeout);
+    }
+
+    BaseType_t send(const T& data, TickType_t timeout = portMAX_DELAY) {
+        return emplace(data, timeout);
+    }
+
+    bool receive_to(T& out, TickType_t timeout = portMAX_DELAY) const {
+        T* item = take(timeout);
+        if (item == nullptr) {
+            return false;
+        }
+        out = std::move(*item);
+        release(item);
+        return true;
+    }
+
+    std::optional<T> receive(TickType_t timeout = portMAX_DELAY) const {
+        T* item = take(timeout);
+        if (item == nullptr) {
+            return std::nullopt;
+        }
+        std::optional<T> out(std::move(*item));
+        release(item);
+        return out;
+    }
+};
+
+#endif //FREERTOS_CPP_POOLED_QUEUE_HPP
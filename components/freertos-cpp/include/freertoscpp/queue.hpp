@@ -8,6 +8,7 @@
 #include <optional>
 #include "freertos.hpp"
 #include "freertos/queue.h"
+#include "queue_sizing.hpp"
 
 namespace augtons {
     namespace freertos {
@@ -15,6 +16,7 @@ namespace augtons {
             struct queue_shared_data {
                 bool has_deleted = false;
                 QueueHandle_t handle = nullptr;
+                size_t depth = 0;
             };
         }
 
@@ -33,8 +35,33 @@ public:
     queue() = default;
 
     explicit queue(size_t length) {
+        alloc_scope scope(alloc_kind::queue);
         shared_data = std::make_shared<details::queue_shared_data>();
-        shared_data->handle = xQueueCreate(sizeof(PointerType), length); // 用指针，记得特化引用
+        shared_data->handle = create_queue<PointerType>(length); // 用指针，记得特化引用
+        shared_data->depth = length;
+    }
+
+    // Same as queue(depth), with the meaning of the argument in the name
+    static queue with_depth(size_t depth) {
+        return queue(depth);
+    }
+
+    // Memory of a queue<T> of `depth` messages: the FreeRTOS queue holds pointers, and
+    // each pending message is a heap box of sizeof(T) (counted with the queue full)
+    static constexpr queue_footprint footprint_for(size_t depth) {
+        queue_footprint f = queue_footprint_of<PointerType>(depth);
+        f.control_bytes += sizeof(details::queue_shared_data);
+        f.pool_bytes = depth * sizeof(T);
+        f.pool_on_heap = true;
+        return f;
+    }
+
+    queue_footprint footprint() const {
+        return footprint_for(is_null() ? 0 : shared_data->depth);
+    }
+
+    size_t depth() const {
+        return is_null() ? 0 : shared_data->depth;
     }
 
     queue(queue&) = default;
@@ -133,6 +160,7 @@ public:
         if (is_null() || has_deleted()) {
             return pdFAIL;
         }
+        alloc_scope scope(alloc_kind::queue);
         T* new_data = new T(std::move(data));    // 重新new一次，通过移动右值来延长生命周期(C+17前)
                                                  // 重新new一次，将临时量实质化(C++17起)用于传入队列
         assert(new_data);
@@ -143,6 +171,7 @@ public:
         if (is_null() || has_deleted()) {
             return pdFAIL;
         }
+        alloc_scope scope(alloc_kind::queue);
         auto *new_data = new T(data);    // 重新new保证正确拷贝
         assert(new_data);
         return xQueueSend(shared_data->handle, &new_data, timeout);
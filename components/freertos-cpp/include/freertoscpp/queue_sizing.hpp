@@ -0,0 +1,50 @@
+#ifndef FREERTOS_CPP_QUEUE_SIZING_HPP
+#define FREERTOS_CPP_QUEUE_SIZING_HPP
+
+#include "freertos.hpp"
+#include "freertos/queue.h"
+
+namespace augtons {
+    namespace freertos {
+        // Memory used by a queue, in bytes
+        struct queue_footprint {
+            size_t depth = 0;          // Items the queue holds
+            size_t item_size = 0;      // Bytes per item in the FreeRTOS queue storage
+            size_t storage_bytes = 0;  // depth * item_size
+            size_t control_bytes = 0;  // FreeRTOS queue control block(s)
+            size_t pool_bytes = 0;     // Message slots outside the queue storage
+            bool pool_on_heap = false; // Slots are heap boxes (worst case: queue full)
+
+            constexpr size_t total() const {
+                return storage_bytes + control_bytes + pool_bytes;
+            }
+
+            void report(const char* name) const {
+                FreeRTOSCpp_LogI("%s: depth %u x %u B = %u B storage, %u B control, %u B %s, %u B total",
+                                 name, (unsigned)depth, (unsigned)item_size, (unsigned)storage_bytes,
+                                 (unsigned)control_bytes, (unsigned)pool_bytes,
+                                 pool_on_heap ? "boxed on heap (queue full)" : "pool", (unsigned)total());
+            }
+        };
+
+        // Footprint of a FreeRTOS queue of `depth` items of type Item
+        template<typename Item>
+        constexpr queue_footprint queue_footprint_of(size_t depth) {
+            queue_footprint f;
+            f.depth = depth;
+            f.item_size = sizeof(Item);
+            f.storage_bytes = depth * sizeof(Item);
+            f.control_bytes = sizeof(StaticQueue_t);
+            return f;
+        }
+
+        // xQueueCreate with the depth and the item type spelled out, so that the two
+        // size arguments cannot be swapped
+        template<typename Item>
+        QueueHandle_t create_queue(size_t depth) {
+            return xQueueCreate(depth, sizeof(Item));
+        }
+    }
+}
+
+#endif //FREERTOS_CPP_QUEUE_SIZING_HPP
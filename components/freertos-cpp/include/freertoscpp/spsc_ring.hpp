@@ -0,0 +1,136 @@
+#ifndef FREERTOS_CPP_SPSC_RING_HPP
+#define FREERTOS_CPP_SPSC_RING_HPP
+
+#include <atomic>
+#include <type_traits>
+#include "freertos.hpp"
+
+// Line size used to keep the producer and consumer indices apart. ESP32 internal SRAM
+// has no data cache, but the indices of the two sides still do not share a word, and
+// on targets with a cache (or on the host) they do not share a line.
+#ifndef FREERTOS_CPP_CACHE_LINE_SIZE
+#define FREERTOS_CPP_CACHE_LINE_SIZE 32
+#endif
+
+// Always inlined, so that calling it from an IRAM_ATTR ISR keeps the code in IRAM
+#define FREERTOS_CPP_ISR_INLINE inline __attribute__((always_inline))
+
+// Lock-free single-producer single-consumer ring of N items (N a power of two).
+// The producer may be an ISR: push_from_isr() is a copy plus two atomic stores, with no
+// kernel call or critical section unless the consumer is blocked waiting for data,
+// in which case it is woken with a direct-to-task notification.
+//
+// The consumer task calls attach_consumer() once and then pop(). The ring uses that
+// task's default notification, so the task must not use it for anything else.
+// When the ring is full the new item is dropped and counted in dropped().
+
+template<typename T, size_t N>
+class augtons::freertos::spsc_ring {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two.");
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable.");
+private:
+    // Written only by the producer
+    alignas(FREERTOS_CPP_CACHE_LINE_SIZE) std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> dropped_count{0};
+    // Written only by the consumer
+    alignas(FREERTOS_CPP_CACHE_LINE_SIZE) std::atomic<uint32_t> tail{0};
+    std::atomic<bool> waiting{false};
+    TaskHandle_t consumer = nullptr;
+    alignas(FREERTOS_CPP_CACHE_LINE_SIZE) T items[N];
+
+    FREERTOS_CPP_ISR_INLINE bool publish(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        // Pairs with the fence in pop(): either the consumer sees the new head before
+        // blocking, or the producer sees `waiting` and wakes it up
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return true;
+    }
+
+    FREERTOS_CPP_ISR_INLINE bool consumer_waiting() {
+        return consumer != nullptr && waiting.load(std::memory_order_relaxed)
+               && waiting.exchange(false, std::memory_order_relaxed);
+    }
+public:
+    spsc_ring() = default;
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+    // Registers the task that will call pop(); by default the calling task
+    void attach_consumer(TaskHandle_t task = nullptr) {
+        consumer = task != nullptr ? task : xTaskGetCurrentTaskHandle();
+    }
+
+    // Producer side, from a task
+    bool push(const T& item) {
+        if (!publish(item)) {
+            return false;
+        }
+        if (consumer_waiting()) {
+            xTaskNotifyGive(consumer);
+        }
+        return true;
+    }
+
+    // Producer side, from an ISR. Yield with portYIELD_FROM_ISR() if *woken is set.
+    FREERTOS_CPP_ISR_INLINE bool push_from_isr(const T& item, BaseType_t* woken) {
+        if (!publish(item)) {
+            return false;
+        }
+        if (consumer_waiting()) {
+            vTaskNotifyGiveFromISR(consumer, woken);
+        }
+        return true;
+    }
+
+    // Consumer side, never blocks
+    bool try_pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: waits up to `timeout` for an item; false on timeout
+    bool pop(T& out, TickType_t timeout = portMAX_DELAY) {
+        TickType_t start = xTaskGetTickCount();
+        while (!try_pop(out)) {
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (try_pop(out)) {
+                waiting.store(false, std::memory_order_relaxed);
+                return true;
+            }
+
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (timeout != portMAX_DELAY && elapsed >= timeout) {
+                waiting.store(false, std::memory_order_relaxed);
+                return false;
+            }
+            ulTaskNotifyTake(pdTRUE, timeout == portMAX_DELAY ? portMAX_DELAY : timeout - elapsed);
+        }
+        return true;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t dropped() const {
+        return dropped_count.load(std::memory_order_relaxed);
+    }
+};
+
+#endif //FREERTOS_CPP_SPSC_RING_HPP
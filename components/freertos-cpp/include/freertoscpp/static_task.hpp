@@ -0,0 +1,63 @@
+#ifndef FREERTOS_CPP_STATIC_TASK_HPP
+#define FREERTOS_CPP_STATIC_TASK_HPP
+
+#include "freertos.hpp"
+#include "freertos_task_factory.hpp"
+
+// Storage for a task created with xTaskCreateStatic: the stack and the TCB are members,
+// so a static_task declared at namespace scope (or `static`) is fully accounted for at
+// link time and creating the task never touches the heap.
+//
+// The task function is a plain TaskFunction_t: std::function and the shared control
+// block used by task<> would allocate. Deleting the task (vTaskDelete, or the function
+// deleting itself) is fine; the storage just becomes reusable by start().
+
+template<uint32_t StackSize>
+class augtons::freertos::static_task {
+    static_assert(StackSize >= configMINIMAL_STACK_SIZE, "Stack is smaller than configMINIMAL_STACK_SIZE.");
+private:
+    StackType_t stack[StackSize / sizeof(StackType_t)];
+    StaticTask_t tcb;
+    TaskHandle_t handle = nullptr;
+public:
+    static_task() = default;
+    static_task(const static_task&) = delete;
+    static_task& operator=(const static_task&) = delete;
+
+    static constexpr uint32_t stack_size() {
+        return StackSize;
+    }
+
+    TaskHandle_t start(
+        const char *const name,
+        const UBaseType_t priority,
+        TaskFunction_t func,
+        void *arg = nullptr,
+        BaseType_t core_id = tskNO_AFFINITY
+    ) {
+        if (handle != nullptr && eTaskGetState(handle) != eDeleted) {
+            FreeRTOSCpp_LogE("Task \"%s\" is already running on this static_task storage.", name);
+            return nullptr;
+        }
+        // ESP-IDF takes the stack depth in bytes
+        handle = xTaskCreateStaticPinnedToCore(func, name, StackSize, arg, priority, stack, &tcb, core_id);
+        return handle;
+    }
+
+    TaskHandle_t native_handle() const {
+        return handle;
+    }
+
+    inline explicit operator TaskHandle_t() const {
+        return native_handle();
+    }
+};
+
+// task_builder<>(...).priority(p).core_id(c).bind(storage, func, arg): same builder as
+// for heap tasks; the stack size comes from the storage and .stack() is ignored.
+template<uint32_t StackSize>
+TaskHandle_t augtons::freertos::task_builder<void>::bind(static_task<StackSize>& storage, TaskFunction_t func, void *arg) {
+    return storage.start(m_name, m_priority, func, arg, m_core_id);
+}
+
+#endif //FREERTOS_CPP_STATIC_TASK_HPP
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "heap_track.h"
+
+// Os hooks de heap rodam dentro do malloc/free, inclusive com a cache da flash
+// desligada: o núcleo fica na IRAM e nunca aloca
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#define HEAP_TRACK_IRAM IRAM_ATTR
+static portMUX_TYPE trava = portMUX_INITIALIZER_UNLOCKED;
+#define TRAVAR() portENTER_CRITICAL_SAFE(&trava)
+#define DESTRAVAR() portEXIT_CRITICAL_SAFE(&trava)
+#else
+#include <pthread.h>
+#define HEAP_TRACK_IRAM
+static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+#define TRAVAR() pthread_mutex_lock(&trava)
+#define DESTRAVAR() pthread_mutex_unlock(&trava)
+#endif
+
+#if (HEAP_TRACK_MAX_VIVAS & (HEAP_TRACK_MAX_VIVAS - 1)) != 0 || HEAP_TRACK_MAX_VIVAS > 65536
+#error "HEAP_TRACK_MAX_VIVAS precisa ser potência de 2, até 65536"
+#endif
+#define MASCARA (HEAP_TRACK_MAX_VIVAS - 1)
+
+// Tamanho e subsistema juntos em 32 bits: alocações de até 512 MB
+#define SUB_BITS 3
+#define TAMANHO_MAX ((1u << (32 - SUB_BITS)) - 1)
+
+// Tabela hash de endereçamento aberto (sondagem linear) com as alocações marcadas
+typedef struct {
+    uintptr_t ptr;  // 0 = livre
+    uint32_t tamanho_sub;
+} entrada_t;
+
+static entrada_t tabela[HEAP_TRACK_MAX_VIVAS];
+static heap_track_amostra_t contadores;
+
+static const char *nomes[HEAP_SUBSISTEMAS] = { "nenhum", "uplink", "wifi", "fila", "tasks" };
+
+static inline HEAP_TRACK_IRAM uint32_t posicao(uintptr_t ptr) {
+    // Blocos do heap são alinhados a 4 bytes; hash multiplicativo de Knuth
+    return (((uint32_t)(ptr >> 2) * 2654435761u) >> 16) & MASCARA;
+}
+
+// Retira a entrada i e puxa para trás as que vieram depois dela na mesma sequência,
+// para a busca nunca parar num buraco antes da entrada procurada
+static HEAP_TRACK_IRAM void apagar(uint32_t i) {
+    uint32_t j = i;
+    while (1) {
+        j = (j + 1) & MASCARA;
+        if (tabela[j].ptr == 0) {
+            break;
+        }
+        uint32_t origem = posicao(tabela[j].ptr);
+        if (((j - origem) & MASCARA) >= ((j - i) & MASCARA)) {
+            tabela[i] = tabela[j];
+            i = j;
+        }
+    }
+    tabela[i].ptr = 0;
+}
+
+HEAP_TRACK_IRAM void heap_track_registrar(const void *ptr, size_t tamanho, heap_sub_t sub) {
+    if (ptr == NULL || sub <= HEAP_SUB_NENHUM || sub >= HEAP_SUBSISTEMAS) {
+        return;
+    }
+    if (tamanho > TAMANHO_MAX) {
+        tamanho = TAMANHO_MAX;
+    }
+
+    TRAVAR();
+    heap_sub_stats_t *s = &contadores.sub[sub];
+    s->alocacoes++;
+    if (contadores.vivas >= HEAP_TRACK_MAX_VIVAS - 1) {
+        // Mantém um lugar vazio, que encerra as buscas
+        contadores.sem_registro++;
+        DESTRAVAR();
+        return;
+    }
+    uint32_t i = posicao((uintptr_t)ptr);
+    while (tabela[i].ptr != 0 && tabela[i].ptr != (uintptr_t)ptr) {
+        i = (i + 1) & MASCARA;
+    }
+    if (tabela[i].ptr == (uintptr_t)ptr) {
+        // O free deste endereço não passou pelo hook; descarta o registro antigo
+        heap_sub_stats_t *antigo = &contadores.sub[tabela[i].tamanho_sub >> (32 - SUB_BITS)];
+        antigo->vivos -= tabela[i].tamanho_sub & TAMANHO_MAX;
+    } else {
+        contadores.vivas++;
+        if (contadores.vivas > contadores.pico_vivas) {
+            contadores.pico_vivas = contadores.vivas;
+        }
+    }
+    tabela[i].ptr = (uintptr_t)ptr;
+    tabela[i].tamanho_sub = ((uint32_t)sub << (32 - SUB_BITS)) | (uint32_t)tamanho;
+    s->vivos += (uint32_t)tamanho;
+    if (s->vivos > s->pico) {
+        s->pico = s->vivos;
+    }
+    DESTRAVAR();
+}
+
+HEAP_TRACK_IRAM void heap_track_remover(const void *ptr) {
+    // Caminho rápido para a grande maioria dos free, de blocos não marcados
+    if (ptr == NULL || *(volatile uint32_t *)&contadores.vivas == 0) {
+        return;
+    }
+
+    TRAVAR();
+    uint32_t i = posicao((uintptr_t)ptr);
+    while (tabela[i].ptr != 0) {
+        if (tabela[i].ptr == (uintptr_t)ptr) {
+            heap_sub_stats_t *s = &contadores.sub[tabela[i].tamanho_sub >> (32 - SUB_BITS)];
+            s->vivos -= tabela[i].tamanho_sub & TAMANHO_MAX;
+            s->liberacoes++;
+            contadores.vivas--;
+            apagar(i);
+            break;
+        }
+        i = (i + 1) & MASCARA;
+    }
+    DESTRAVAR();
+}
+
+void heap_track_stats(heap_track_amostra_t *amostra) {
+    TRAVAR();
+    *amostra = contadores;
+    DESTRAVAR();
+}
+
+void heap_track_reset(void) {
+    TRAVAR();
+    memset(tabela, 0, sizeof(tabela));
+    memset(&contadores, 0, sizeof(contadores));
+    DESTRAVAR();
+}
+
+const char *heap_track_nome(heap_sub_t sub) {
+    return sub < HEAP_SUBSISTEMAS ? nomes[sub] : "?";
+}
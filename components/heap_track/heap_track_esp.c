@@ -0,0 +1,112 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "heap_track.h"
+
+static const char* TAG = "HEAP_TRACK";
+
+// A marca de cada task fica no application task tag do FreeRTOS. Ninguém chama
+// xTaskCallApplicationTaskHook neste projeto, então o valor guardado não precisa ser
+// uma função de verdade.
+#if CONFIG_FREERTOS_USE_APPLICATION_TASK_TAG
+static volatile bool marcas_em_uso = false;  // Evita consultar a task antes da primeira marca
+
+static inline IRAM_ATTR heap_sub_t marca_atual(void) {
+    if (!marcas_em_uso || xPortInIsrContext() || xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return HEAP_SUB_NENHUM;
+    }
+    return (heap_sub_t)(uintptr_t)xTaskGetApplicationTaskTag(NULL);
+}
+
+heap_sub_t heap_track_entrar(heap_sub_t sub) {
+    heap_sub_t anterior = (heap_sub_t)(uintptr_t)xTaskGetApplicationTaskTag(NULL);
+    vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)(uintptr_t)sub);
+    marcas_em_uso = true;
+    return anterior;
+}
+
+void heap_track_sair(heap_sub_t anterior) {
+    vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)(uintptr_t)anterior);
+}
+
+bool heap_track_marcar_task(const char *nome, heap_sub_t sub) {
+    TaskHandle_t task = xTaskGetHandle(nome);
+    if (task == NULL) {
+        return false;
+    }
+    vTaskSetApplicationTaskTag(task, (TaskHookFunction_t)(uintptr_t)sub);
+    marcas_em_uso = true;
+    return true;
+}
+#else
+static inline heap_sub_t marca_atual(void) {
+    return HEAP_SUB_NENHUM;
+}
+
+heap_sub_t heap_track_entrar(heap_sub_t sub) {
+    return HEAP_SUB_NENHUM;
+}
+
+void heap_track_sair(heap_sub_t anterior) {
+}
+
+bool heap_track_marcar_task(const char *nome, heap_sub_t sub) {
+    return false;
+}
+#endif
+
+#if CONFIG_HEAP_USE_HOOKS
+// Chamados pelo heap_caps a cada alocação e liberação bem-sucedidas
+IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+    heap_sub_t sub = marca_atual();
+    if (sub != HEAP_SUB_NENHUM) {
+        heap_track_registrar(ptr, size, sub);
+    }
+}
+
+IRAM_ATTR void esp_heap_trace_free_hook(void *ptr) {
+    heap_track_remover(ptr);
+}
+#endif
+
+#if CONFIG_FREERTOS_CPP_ALLOC_HOOKS
+// Alocações da freertos-cpp: kind 0 são as caixas das mensagens de queue<T>, 1 os
+// blocos de controle, TCB e pilha de task<>
+int freertos_cpp_alloc_enter(int kind) {
+    return (int)heap_track_entrar(kind == 0 ? HEAP_SUB_FILA : HEAP_SUB_TASKS);
+}
+
+void freertos_cpp_alloc_exit(int token) {
+    heap_track_sair((heap_sub_t)token);
+}
+#endif
+
+void heap_track_amostrar(heap_track_amostra_t *amostra) {
+    heap_track_stats(amostra);
+    amostra->livre = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    amostra->livre_minimo = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    amostra->maior_bloco = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+void heap_track_relatorio(const heap_track_amostra_t *amostra) {
+    // Fragmentação: parte do livre que não cabe no maior bloco
+    uint32_t fragmentacao = amostra->livre > 0 ? 100 - (uint32_t)((uint64_t)amostra->maior_bloco * 100 / amostra->livre) : 0;
+    ESP_LOGI(TAG, "Livre %lu B (mínimo %lu B), maior bloco %lu B, fragmentação %lu%%",
+             (unsigned long)amostra->livre, (unsigned long)amostra->livre_minimo,
+             (unsigned long)amostra->maior_bloco, (unsigned long)fragmentacao);
+    for (int sub = HEAP_SUB_NENHUM + 1; sub < HEAP_SUBSISTEMAS; sub++) {
+        const heap_sub_stats_t *s = &amostra->sub[sub];
+        ESP_LOGI(TAG, "%-7s %6lu B vivos (pico %lu B), %lu alocações / %lu liberações",
+                 heap_track_nome((heap_sub_t)sub), (unsigned long)s->vivos, (unsigned long)s->pico,
+                 (unsigned long)s->alocacoes, (unsigned long)s->liberacoes);
+    }
+    if (amostra->sem_registro > 0) {
+        ESP_LOGW(TAG, "%lu alocações marcadas fora da tabela (%u lugares, pico %lu)",
+                 (unsigned long)amostra->sem_registro, (unsigned)HEAP_TRACK_MAX_VIVAS,
+                 (unsigned long)amostra->pico_vivas);
+    }
+}
@@ -0,0 +1,202 @@
+// Teste de resistência do heap_track no host. Várias threads alocam e liberam blocos
+// de tamanhos aleatórios, com e sem marca, passando pelo núcleo como os hooks do
+// ESP-IDF fariam. No fim os contadores de cada subsistema têm de bater com a conta
+// feita pelo próprio teste, e a tabela tem de ficar vazia depois de liberar tudo.
+// Antes, dois testes determinísticos: tabela cheia e remoção no meio de colisões.
+//
+// Uso: heap_track_soak [operações por thread]
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "heap_track.h"
+
+#define THREADS 4
+#define VIVOS_POR_THREAD 48
+#define TAMANHO_MAX 2048
+
+static int falhas = 0;
+
+#define CHECAR(cond) do { \
+    if (!(cond)) { \
+        printf("FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        falhas++; \
+    } \
+} while (0)
+
+// Conta feita pelo teste, para comparar com a do heap_track
+static atomic_uint vivos_esperados[HEAP_SUBSISTEMAS];
+static atomic_uint alocacoes_esperadas[HEAP_SUBSISTEMAS];
+
+// O que os hooks fazem: registrar depois do malloc, remover antes do free
+static void *alocar(size_t tamanho, heap_sub_t sub) {
+    void *p = malloc(tamanho);
+    if (p != NULL) {
+        heap_track_registrar(p, tamanho, sub);
+    }
+    return p;
+}
+
+static void liberar(void *p) {
+    heap_track_remover(p);
+    free(p);
+}
+
+typedef struct {
+    void *ptr;
+    size_t tamanho;
+    heap_sub_t sub;
+} bloco_t;
+
+typedef struct {
+    unsigned semente;
+    long operacoes;
+    bloco_t vivos[VIVOS_POR_THREAD];
+} thread_t;
+
+static void soltar(bloco_t *b) {
+    if (b->ptr == NULL) {
+        return;
+    }
+    liberar(b->ptr);
+    if (b->sub != HEAP_SUB_NENHUM) {
+        atomic_fetch_sub(&vivos_esperados[b->sub], (unsigned)b->tamanho);
+    }
+    b->ptr = NULL;
+}
+
+static void *rodar(void *arg) {
+    thread_t *t = arg;
+    for (long i = 0; i < t->operacoes; i++) {
+        bloco_t *b = &t->vivos[rand_r(&t->semente) % VIVOS_POR_THREAD];
+        if (b->ptr != NULL) {
+            soltar(b);
+            continue;
+        }
+        b->tamanho = 1 + rand_r(&t->semente) % TAMANHO_MAX;
+        b->sub = (heap_sub_t)(rand_r(&t->semente) % HEAP_SUBSISTEMAS);  // Inclui sem marca
+        b->ptr = alocar(b->tamanho, b->sub);
+        if (b->ptr != NULL && b->sub != HEAP_SUB_NENHUM) {
+            atomic_fetch_add(&vivos_esperados[b->sub], (unsigned)b->tamanho);
+            atomic_fetch_add(&alocacoes_esperadas[b->sub], 1);
+        }
+    }
+    return NULL;
+}
+
+// Endereços falsos, alinhados como os do heap, só para a tabela
+static const void *falso(uintptr_t i) {
+    return (const void *)(0x3ffb0000u + i * 4);
+}
+
+static void testar_tabela_cheia(void) {
+    heap_track_reset();
+    for (uintptr_t i = 0; i < HEAP_TRACK_MAX_VIVAS; i++) {
+        heap_track_registrar(falso(i), 10, HEAP_SUB_WIFI);
+    }
+    heap_track_amostra_t a;
+    heap_track_stats(&a);
+    CHECAR(a.vivas == HEAP_TRACK_MAX_VIVAS - 1);  // Um lugar fica sempre vazio
+    CHECAR(a.sem_registro == 1);
+    CHECAR(a.sub[HEAP_SUB_WIFI].alocacoes == HEAP_TRACK_MAX_VIVAS);
+    CHECAR(a.sub[HEAP_SUB_WIFI].vivos == (HEAP_TRACK_MAX_VIVAS - 1) * 10);
+
+    // Liberar o que não coube não mexe nos contadores
+    for (uintptr_t i = 0; i < HEAP_TRACK_MAX_VIVAS; i++) {
+        heap_track_remover(falso(i));
+    }
+    heap_track_stats(&a);
+    CHECAR(a.vivas == 0);
+    CHECAR(a.sub[HEAP_SUB_WIFI].vivos == 0);
+    CHECAR(a.sub[HEAP_SUB_WIFI].liberacoes == HEAP_TRACK_MAX_VIVAS - 1);
+}
+
+static void testar_colisoes(void) {
+    // Metade da tabela, removida fora de ordem: cada remoção tem de achar o seu
+    // registro mesmo depois de outras entradas da mesma sequência saírem
+    heap_track_reset();
+    enum { N = HEAP_TRACK_MAX_VIVAS / 2 };
+    for (uintptr_t i = 0; i < N; i++) {
+        heap_track_registrar(falso(i * 7), i + 1, HEAP_SUB_UPLINK);
+    }
+    uint32_t esperado = N * (N + 1) / 2;
+    unsigned semente = 1;
+    uintptr_t ordem[N];
+    for (uintptr_t i = 0; i < N; i++) {
+        ordem[i] = i;
+    }
+    for (uintptr_t i = N - 1; i > 0; i--) {
+        uintptr_t j = rand_r(&semente) % (i + 1);
+        uintptr_t tmp = ordem[i];
+        ordem[i] = ordem[j];
+        ordem[j] = tmp;
+    }
+    heap_track_amostra_t a;
+    for (uintptr_t k = 0; k < N; k++) {
+        heap_track_remover(falso(ordem[k] * 7));
+        esperado -= ordem[k] + 1;
+        heap_track_stats(&a);
+        if (a.sub[HEAP_SUB_UPLINK].vivos != esperado) {
+            CHECAR(a.sub[HEAP_SUB_UPLINK].vivos == esperado);
+            break;
+        }
+    }
+    heap_track_stats(&a);
+    CHECAR(a.vivas == 0);
+    CHECAR(a.sub[HEAP_SUB_UPLINK].pico == N * (N + 1) / 2);
+}
+
+int main(int argc, char **argv) {
+    long operacoes = argc > 1 ? atol(argv[1]) : 200000;
+
+    testar_tabela_cheia();
+    testar_colisoes();
+
+    heap_track_reset();
+    static thread_t threads[THREADS];
+    pthread_t ids[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        threads[i].semente = 1234u + (unsigned)i;
+        threads[i].operacoes = operacoes;
+        pthread_create(&ids[i], NULL, rodar, &threads[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(ids[i], NULL);
+    }
+
+    heap_track_amostra_t a;
+    heap_track_stats(&a);
+    CHECAR(a.sem_registro == 0);
+    for (int sub = HEAP_SUB_NENHUM + 1; sub < HEAP_SUBSISTEMAS; sub++) {
+        const heap_sub_stats_t *s = &a.sub[sub];
+        printf("%-7s %7u B vivos (pico %u B), %u alocações / %u liberações\n",
+               heap_track_nome((heap_sub_t)sub), s->vivos, s->pico, s->alocacoes, s->liberacoes);
+        CHECAR(s->vivos == atomic_load(&vivos_esperados[sub]));
+        CHECAR(s->alocacoes == atomic_load(&alocacoes_esperadas[sub]));
+        CHECAR(s->pico >= s->vivos);
+    }
+    CHECAR(a.sub[HEAP_SUB_NENHUM].alocacoes == 0);
+    printf("tabela: %u vivas (pico %u de %u)\n", a.vivas, a.pico_vivas, (unsigned)HEAP_TRACK_MAX_VIVAS);
+
+    for (int i = 0; i < THREADS; i++) {
+        for (int j = 0; j < VIVOS_POR_THREAD; j++) {
+            soltar(&threads[i].vivos[j]);
+        }
+    }
+    heap_track_stats(&a);
+    CHECAR(a.vivas == 0);
+    for (int sub = 0; sub < HEAP_SUBSISTEMAS; sub++) {
+        CHECAR(a.sub[sub].vivos == 0);
+        CHECAR(a.sub[sub].alocacoes == a.sub[sub].liberacoes);
+    }
+
+    if (falhas != 0) {
+        printf("%d verificação(ões) falharam\n", falhas);
+        return 1;
+    }
+    printf("contabilidade confere após %ld operações em %d threads\n", operacoes * THREADS, THREADS);
+    return 0;
+}
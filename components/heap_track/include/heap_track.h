@@ -0,0 +1,83 @@
+#ifndef HEAP_TRACK_H
+#define HEAP_TRACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Contabilidade do heap por subsistema. Cada alocação feita com uma marca ativa
+// (uplink, wifi, fila, tasks) entra numa tabela fixa de alocações vivas, de modo que
+// a liberação, venha de onde vier, desconta do subsistema certo. O núcleo
+// (heap_track.c) é C puro e roda no host; heap_track_esp.c liga os hooks de heap do
+// ESP-IDF (CONFIG_HEAP_USE_HOOKS) e marca as alocações pela task que as faz.
+
+typedef enum {
+    HEAP_SUB_NENHUM = 0,  // Sem marca: não entra na tabela
+    HEAP_SUB_UPLINK,
+    HEAP_SUB_WIFI,
+    HEAP_SUB_FILA,
+    HEAP_SUB_TASKS,
+    HEAP_SUBSISTEMAS,
+} heap_sub_t;
+
+// Alocações vivas acompanhadas ao mesmo tempo (potência de 2)
+#ifndef HEAP_TRACK_MAX_VIVAS
+#define HEAP_TRACK_MAX_VIVAS 512
+#endif
+
+typedef struct {
+    uint32_t vivos;        // Bytes alocados e ainda não liberados
+    uint32_t pico;         // Maior valor de vivos
+    uint32_t alocacoes;
+    uint32_t liberacoes;
+} heap_sub_stats_t;
+
+typedef struct {
+    heap_sub_stats_t sub[HEAP_SUBSISTEMAS];  // sub[HEAP_SUB_NENHUM] fica zerado
+    uint32_t sem_registro;  // Alocações marcadas que não couberam na tabela
+    uint32_t vivas;         // Entradas ocupadas na tabela
+    uint32_t pico_vivas;
+    // Heap do sistema (heap_track_amostrar no ESP-IDF; zero no host)
+    uint32_t livre;
+    uint32_t livre_minimo;  // Menor livre desde o boot
+    uint32_t maior_bloco;   // Maior bloco livre: o que cabe numa única alocação
+} heap_track_amostra_t;
+
+// Núcleo: registra e remove alocações. Seguros em ISR e entre núcleos; não alocam.
+void heap_track_registrar(const void *ptr, size_t tamanho, heap_sub_t sub);
+void heap_track_remover(const void *ptr);
+
+// Copia os contadores do núcleo
+void heap_track_stats(heap_track_amostra_t *amostra);
+
+// Zera a tabela e os contadores
+void heap_track_reset(void);
+
+const char *heap_track_nome(heap_sub_t sub);
+
+#ifdef ESP_PLATFORM
+// Marca as alocações da task atual com sub até heap_track_sair. Retorna a marca
+// anterior, a ser passada a heap_track_sair; os escopos podem ser aninhados.
+heap_sub_t heap_track_entrar(heap_sub_t sub);
+void heap_track_sair(heap_sub_t anterior);
+
+// Marca de vez as alocações de uma task já criada, pelo nome (tasks do ESP-IDF
+// como "wifi" ou "tiT"). Retorna false se a task não existe.
+bool heap_track_marcar_task(const char *nome, heap_sub_t sub);
+
+// Contadores do núcleo mais o estado do heap interno (MALLOC_CAP_8BIT)
+void heap_track_amostrar(heap_track_amostra_t *amostra);
+
+// Registra no log o estado do heap e o uso de cada subsistema
+void heap_track_relatorio(const heap_track_amostra_t *amostra);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
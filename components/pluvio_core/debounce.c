@@ -0,0 +1,44 @@
+#include <string.h>
+
+#include "debounce.h"
+
+void debounce_init(debounce_t *d, const debounce_config_t *cfg) {
+    memset(d, 0, sizeof(*d));
+    d->cfg = *cfg;
+    d->intervalo_min_us = cfg->taxa_max_por_min ? 60000000u / cfg->taxa_max_por_min : 0;
+}
+
+bool debounce_edge(debounce_t *d, int64_t timestamp_us, int nivel) {
+    if (nivel == d->cfg.nivel_ativo) {
+        // Contato fechou: a trepidação da abertura anterior cai no período refratário
+        if (d->tem_aceita && timestamp_us - d->ultima_aceita_us < d->cfg.refratario_us) {
+            d->rejeitadas_refratario++;
+            return false;
+        }
+        if (!d->em_pulso) {
+            d->em_pulso = true;
+            d->inicio_pulso_us = timestamp_us;
+        }
+        return false;
+    }
+
+    // Contato abriu: só conta se havia um pulso em andamento
+    if (!d->em_pulso) {
+        return false;
+    }
+    d->em_pulso = false;
+
+    if (timestamp_us - d->inicio_pulso_us < d->cfg.largura_min_us) {
+        d->rejeitadas_curtas++;
+        return false;
+    }
+    if (d->tem_aceita && timestamp_us - d->ultima_aceita_us < d->intervalo_min_us) {
+        d->rejeitadas_taxa++;
+        return false;
+    }
+
+    d->tem_aceita = true;
+    d->ultima_aceita_us = timestamp_us;
+    d->aceitas++;
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef ESCRITOR_H
+#define ESCRITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Escrita de texto direto num buffer, sem snprintf nem alocação, compartilhada pelos
+// codificadores do envio. Uso interno do pluvio_core.
+
+typedef struct {
+    char *p;
+    char *fim;
+    int estourou;
+} escritor_t;
+
+static inline void escrever(escritor_t *e, const char *s, size_t len) {
+    if (e->estourou || (size_t)(e->fim - e->p) < len) {
+        e->estourou = 1;
+        return;
+    }
+    memcpy(e->p, s, len);
+    e->p += len;
+}
+
+#define ESCREVER_LITERAL(e, s) escrever((e), (s), sizeof(s) - 1)
+
+static inline void escrever_uint(escritor_t *e, uint32_t v, int digitos_min) {
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0 || n < digitos_min);
+    escrever(e, tmp + sizeof(tmp) - n, (size_t)n);
+}
+
+// Valor com duas casas decimais, como o "%.2f" do envio individual
+static inline void escrever_fixo2(escritor_t *e, float v) {
+    if (v < 0) {
+        ESCREVER_LITERAL(e, "-");
+        v = -v;
+    }
+    if (v > 42949672.0f) {
+        v = 42949672.0f;
+    }
+    uint32_t centesimos = (uint32_t)(v * 100.0f + 0.5f);
+    escrever_uint(e, centesimos / 100, 1);
+    ESCREVER_LITERAL(e, ".");
+    escrever_uint(e, centesimos % 100, 2);
+}
+
+// Data civil a partir de dias desde 1970-01-01 (algoritmo de Howard Hinnant)
+static inline void dias_para_data(int32_t dias, uint32_t *ano, uint32_t *mes, uint32_t *dia) {
+    dias += 719468;
+    int32_t era = (dias >= 0 ? dias : dias - 146096) / 146097;
+    uint32_t doe = (uint32_t)(dias - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    *dia = doy - (153 * mp + 2) / 5 + 1;
+    *mes = mp < 10 ? mp + 3 : mp - 9;
+    *ano = (uint32_t)(yoe + era * 400) + (*mes <= 2);
+}
+
+// ISO 8601 em UTC: 2024-01-31T23:59:59Z
+static inline void escrever_data(escritor_t *e, uint32_t epoch) {
+    uint32_t ano, mes, dia;
+    uint32_t segundos_dia = epoch % 86400;
+    dias_para_data((int32_t)(epoch / 86400), &ano, &mes, &dia);
+
+    escrever_uint(e, ano, 4);
+    ESCREVER_LITERAL(e, "-");
+    escrever_uint(e, mes, 2);
+    ESCREVER_LITERAL(e, "-");
+    escrever_uint(e, dia, 2);
+    ESCREVER_LITERAL(e, "T");
+    escrever_uint(e, segundos_dia / 3600, 2);
+    ESCREVER_LITERAL(e, ":");
+    escrever_uint(e, segundos_dia / 60 % 60, 2);
+    ESCREVER_LITERAL(e, ":");
+    escrever_uint(e, segundos_dia % 60, 2);
+    ESCREVER_LITERAL(e, "Z");
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_partition.h"
+#include "esp_partition_fake.h"
+#include "esp_rom_crc.h"
+
+static esp_partition_t particao;
+static uint8_t *flash = NULL;
+static int escritas_restantes = -1;  // -1: sem queda de energia programada
+
+void esp_partition_fake_criar(const char *label, size_t tamanho) {
+    free(flash);
+    flash = malloc(tamanho);
+    memset(flash, 0xFF, tamanho);
+    memset(&particao, 0, sizeof(particao));
+    particao.type = ESP_PARTITION_TYPE_DATA;
+    particao.subtype = ESP_PARTITION_SUBTYPE_ANY;
+    particao.size = (uint32_t)tamanho;
+    snprintf(particao.label, sizeof(particao.label), "%s", label);
+    escritas_restantes = -1;
+}
+
+uint8_t *esp_partition_fake_dados(void) {
+    return flash;
+}
+
+void esp_partition_fake_cortar_apos(int n) {
+    escritas_restantes = n;
+}
+
+void esp_partition_fake_religar(void) {
+    escritas_restantes = -1;
+}
+
+bool esp_partition_fake_salvar(const char *caminho) {
+    FILE *f = fopen(caminho, "wb");
+    if (f == NULL) {
+        perror(caminho);
+        return false;
+    }
+    bool ok = fwrite(flash, 1, particao.size, f) == particao.size;
+    return fclose(f) == 0 && ok;
+}
+
+static bool dentro(const esp_partition_t *p, size_t offset, size_t size) {
+    return p == &particao && flash != NULL && offset <= p->size && size <= p->size - offset;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (flash == NULL || type != particao.type ||
+        (subtype != ESP_PARTITION_SUBTYPE_ANY && subtype != particao.subtype) ||
+        (label != NULL && strcmp(label, particao.label) != 0)) {
+        return NULL;
+    }
+    return &particao;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t src_offset, void *dst, size_t size) {
+    if (!dentro(p, src_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, flash + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t dst_offset, const void *src, size_t size) {
+    if (!dentro(p, dst_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (escritas_restantes == 0) {
+        return ESP_FAIL;
+    }
+    if (escritas_restantes > 0) {
+        escritas_restantes--;
+    }
+    const uint8_t *origem = src;
+    for (size_t i = 0; i < size; i++) {
+        flash[dst_offset + i] &= origem[i];  // A flash só leva bits de 1 para 0
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size) {
+    if (!dentro(p, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (offset % ESP_PARTITION_FAKE_SETOR != 0 || size % ESP_PARTITION_FAKE_SETOR != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(flash + offset, 0xFF, size);
+    return ESP_OK;
+}
+
+// CRC-32 refletido (polinômio 0xEDB88320) com inversão na entrada e na saída, como a ROM
+uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+const char *esp_err_to_name(esp_err_t err) {
+    switch (err) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    default: return "UNKNOWN ERROR";
+    }
+}
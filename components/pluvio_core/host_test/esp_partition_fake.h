@@ -0,0 +1,26 @@
+#ifndef ESP_PARTITION_FAKE_H
+#define ESP_PARTITION_FAKE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Partição falsa em RAM atrás do esp_partition.h, com as regras da flash NOR: a
+// escrita só zera bits (faz AND com o conteúdo) e só o apagamento de um setor inteiro
+// volta os bytes para 0xFF. Uma partição de cada vez.
+#define ESP_PARTITION_FAKE_SETOR 4096
+
+// Cria a partição apagada; a anterior é descartada. tamanho é múltiplo do setor.
+void esp_partition_fake_criar(const char *label, size_t tamanho);
+
+// Conteúdo atual, para o teste inspecionar ou corromper como a flash faria
+uint8_t *esp_partition_fake_dados(void);
+
+// Queda de energia: as n próximas escritas passam e as seguintes falham, até religar
+void esp_partition_fake_cortar_apos(int n);
+void esp_partition_fake_religar(void);
+
+// Grava a imagem num arquivo, como o parttool.py read_partition
+bool esp_partition_fake_salvar(const char *caminho);
+
+#endif
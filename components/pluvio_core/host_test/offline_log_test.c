@@ -0,0 +1,311 @@
+// Testes do log offline (main/offline_log.c) no host, sobre a partição falsa em RAM
+// de esp_partition_fake.c: ordem de gravação e envio ao longo de mais de uma volta,
+// remontagem no meio da volta, registro sem a palavra de commit, CRC corrompido e
+// contagem das leituras descartadas com o log cheio.
+//
+// Com um caminho, grava também a imagem de uma partição com leituras pendentes,
+// enviadas e inválidas, e em <imagem>.esperado o que o pluvlog_dump.py deve listar
+// (conferido por pluvlog_dump_test.py).
+//
+// Uso: offline_log_test [imagem]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_partition_fake.h"
+#include "leitura.h"
+#include "offline_log.h"
+
+// 4 setores de 78 slots de 52 bytes (leitura_t de 36 bytes + CRC, seq, commit, enviado)
+#define SETORES 4
+#define SLOTS_POR_SETOR 78
+#define SLOTS (SETORES * SLOTS_POR_SETOR)
+#define CAB_SETOR 16
+#define TAM_SLOT 52
+#define BOOT 7
+
+static int falhas = 0;
+
+#define CHECAR(cond) do { \
+    if (!(cond)) { \
+        printf("FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        falhas++; \
+    } \
+} while (0)
+
+// A leitura de número id: o teste a reconhece pelo uptime_s. Sem epoch, como antes
+// da sincronização do relógio, o pluvlog_dump.py mostra o boot e o uptime.
+static esp_err_t gravar(uint32_t id) {
+    leitura_t leitura;
+    memset(&leitura, 0, sizeof(leitura));
+    leitura.uptime_s = id;
+    leitura.boot = BOOT;
+    leitura.basculadas = (uint16_t)(id % 1000);
+    leitura.campos[0] = (float)id / 4.0f;
+    return offline_log_append(&leitura);
+}
+
+static void nova_particao(void) {
+    esp_partition_fake_criar("pluvlog", SETORES * ESP_PARTITION_FAKE_SETOR);
+    CHECAR(offline_log_init(sizeof(leitura_t)) == ESP_OK);
+    CHECAR(offline_log_pending() == 0);
+}
+
+// Reinício do dispositivo: o estado em RAM é reconstruído a partir da flash
+static void remontar(void) {
+    CHECAR(offline_log_init(sizeof(leitura_t)) == ESP_OK);
+}
+
+// Envia até n leituras pendentes, conferindo que saem na ordem em que foram gravadas,
+// pulando as que o teste sabe que se perderam
+static uint32_t esperado;
+
+static void enviar(size_t n, uint32_t pular) {
+    leitura_t leituras[16];
+    while (n > 0) {
+        size_t lote = n < 16 ? n : 16;
+        size_t lidas = offline_log_peek(leituras, lote);
+        if (lidas == 0) {
+            break;
+        }
+        for (size_t i = 0; i < lidas; i++) {
+            if (esperado == pular) {
+                esperado++;
+            }
+            CHECAR(leituras[i].uptime_s == esperado);
+            CHECAR(leituras[i].boot == BOOT);
+            CHECAR(leituras[i].basculadas == esperado % 1000);
+            esperado = leituras[i].uptime_s + 1;
+        }
+        CHECAR(offline_log_consume(lidas) == ESP_OK);
+        n -= lidas;
+    }
+}
+
+#define NENHUMA UINT32_MAX
+
+static void testar_voltas(void) {
+    nova_particao();
+    esperado = 0;
+
+    // Mais de duas voltas pela partição, com as leituras acumulando devagar: uma em
+    // cada cinco fica para depois, sem nunca encher o log
+    uint32_t gravadas = 0;
+    for (uint32_t id = 0; id < 2 * SLOTS + 100; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+        gravadas++;
+        if (id % 5 != 4) {
+            enviar(1, NENHUMA);
+        }
+    }
+    CHECAR(offline_log_pending() == gravadas - esperado);
+    CHECAR(offline_log_pending() > SLOTS_POR_SETOR);
+    enviar(SIZE_MAX, NENHUMA);
+    CHECAR(esperado == gravadas);
+    CHECAR(offline_log_pending() == 0);
+    CHECAR(offline_log_lost() == 0);
+
+    leitura_t leitura;
+    CHECAR(offline_log_peek(&leitura, 1) == 0);
+}
+
+static void testar_remontagem(void) {
+    nova_particao();
+    esperado = 0;
+
+    // Setor 0 cheio e o 1 pela metade, com parte já enviada
+    for (uint32_t id = 0; id < 100; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    enviar(30, NENHUMA);
+    remontar();
+    CHECAR(offline_log_pending() == 70);
+    enviar(10, NENHUMA);
+    CHECAR(esperado == 40);
+
+    // Segue até a segunda volta e remonta de novo com a cabeça no meio de um setor
+    uint32_t id = 100;
+    for (; id < SLOTS + 150; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+        if (id % 4 != 0) {
+            enviar(1, NENHUMA);
+        }
+    }
+    CHECAR((SLOTS + 150) % SLOTS_POR_SETOR != 0);
+    uint32_t pendentes = offline_log_pending();
+    CHECAR(pendentes == id - esperado);
+    remontar();
+    CHECAR(offline_log_pending() == pendentes);
+
+    // Gravações depois da remontagem continuam a sequência, depois das antigas
+    for (uint32_t fim = id + 20; id < fim; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    enviar(SIZE_MAX, NENHUMA);
+    CHECAR(esperado == id);
+    CHECAR(offline_log_pending() == 0);
+    CHECAR(offline_log_lost() == 0);
+}
+
+static void testar_commit_ausente(void) {
+    nova_particao();
+    esperado = 0;
+
+    for (uint32_t id = 0; id < 10; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    // Queda de energia entre os dados e o commit da leitura 10
+    esp_partition_fake_cortar_apos(1);
+    CHECAR(gravar(10) != ESP_OK);
+    esp_partition_fake_religar();
+
+    // Os dados ficaram na flash, sem a palavra de commit
+    const uint8_t *slot = esp_partition_fake_dados() + CAB_SETOR + 10 * TAM_SLOT;
+    uint32_t uptime, commit;
+    memcpy(&uptime, slot + 8 + 4, sizeof(uptime));
+    memcpy(&commit, slot + TAM_SLOT - 8, sizeof(commit));
+    CHECAR(uptime == 10);
+    CHECAR(commit == UINT32_MAX);
+
+    remontar();
+    CHECAR(offline_log_pending() == 10);
+    CHECAR(gravar(11) == ESP_OK);
+    CHECAR(gravar(12) == ESP_OK);
+    CHECAR(offline_log_pending() == 12);
+    enviar(SIZE_MAX, 10);
+    CHECAR(esperado == 13);
+    CHECAR(offline_log_pending() == 0);
+}
+
+// Zera um bit (o que a flash permite) nos dados da leitura do slot indicado
+static void corromper(uint32_t setor, uint32_t slot) {
+    uint8_t *dados = esp_partition_fake_dados() + setor * ESP_PARTITION_FAKE_SETOR + CAB_SETOR +
+                     slot * TAM_SLOT + 8;
+    for (int i = 0; i < 36; i++) {
+        if (dados[i] != 0) {
+            dados[i] &= (uint8_t)(dados[i] - 1);
+            return;
+        }
+    }
+}
+
+static void testar_crc(void) {
+    nova_particao();
+    esperado = 0;
+
+    for (uint32_t id = 0; id < 20; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    corromper(0, 5);
+    remontar();
+    CHECAR(offline_log_pending() == 19);
+    enviar(SIZE_MAX, 5);
+    CHECAR(esperado == 20);
+    CHECAR(offline_log_pending() == 0);
+}
+
+static void testar_estouro(void) {
+    nova_particao();
+    esperado = 0;
+
+    // A última gravação da volta enche o setor 3 e reabre o 0: as 78 leituras mais
+    // antigas são descartadas para dar lugar às novas
+    for (uint32_t id = 0; id < SLOTS - 1; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    CHECAR(offline_log_lost() == 0);
+    CHECAR(offline_log_pending() == SLOTS - 1);
+    CHECAR(gravar(SLOTS - 1) == ESP_OK);
+    CHECAR(offline_log_lost() == SLOTS_POR_SETOR);
+    CHECAR(offline_log_pending() == SLOTS - SLOTS_POR_SETOR);
+
+    // Mais um setor cheio descarta o seguinte
+    for (uint32_t id = SLOTS; id < SLOTS + SLOTS_POR_SETOR; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+    }
+    CHECAR(offline_log_lost() == 2 * SLOTS_POR_SETOR);
+    CHECAR(offline_log_pending() == SLOTS - SLOTS_POR_SETOR);
+
+    // A contagem de perdas é da sessão; as pendentes sobrevivem à remontagem
+    remontar();
+    CHECAR(offline_log_lost() == 0);
+    CHECAR(offline_log_pending() == SLOTS - SLOTS_POR_SETOR);
+    esperado = 2 * SLOTS_POR_SETOR;
+    enviar(SIZE_MAX, NENHUMA);
+    CHECAR(esperado == SLOTS + SLOTS_POR_SETOR);
+    CHECAR(offline_log_pending() == 0);
+}
+
+// Uma partição depois de mais de uma volta, com leituras enviadas, pendentes, uma sem
+// commit e uma com o CRC corrompido
+static bool gravar_imagem(const char *caminho) {
+    nova_particao();
+    esperado = 0;
+
+    const uint32_t gravadas = SLOTS + 88;
+    for (uint32_t id = 0; id < gravadas; id++) {
+        CHECAR(gravar(id) == ESP_OK);
+        if (id % 4 != 3) {
+            enviar(1, NENHUMA);
+        }
+    }
+    uint32_t pendentes = gravadas - esperado;
+    const uint32_t sem_commit = gravadas;
+    esp_partition_fake_cortar_apos(1);
+    CHECAR(gravar(sem_commit) != ESP_OK);
+    esp_partition_fake_religar();
+
+    // Slots usados, contando o sem commit: a cabeça está no setor 1, que foi apagado ao
+    // ser reaberto, e os outros três setores estão cheios
+    const uint32_t slots = gravadas + 1;
+    CHECAR(slots / SLOTS_POR_SETOR % SETORES == 1);
+    uint32_t na_flash = (SETORES - 1) * SLOTS_POR_SETOR + slots % SLOTS_POR_SETOR;
+
+    // Corrompe uma das pendentes: a primeira da segunda volta, no início do setor 0
+    const uint32_t corrompida = SLOTS;
+    CHECAR(corrompida >= esperado);
+    corromper(0, 0);
+    remontar();
+    pendentes--;
+    CHECAR(offline_log_pending() == pendentes);
+
+    char esperado_caminho[512];
+    snprintf(esperado_caminho, sizeof(esperado_caminho), "%s.esperado", caminho);
+    FILE *f = fopen(esperado_caminho, "w");
+    if (f == NULL || !esp_partition_fake_salvar(caminho)) {
+        perror(esperado_caminho);
+        return false;
+    }
+    fprintf(f, "pendentes %lu\n", (unsigned long)pendentes);
+    fprintf(f, "enviados %lu\n", (unsigned long)(na_flash - pendentes - 2));
+    fprintf(f, "invalidos 2\n");
+    leitura_t leituras[SLOTS];
+    size_t n = offline_log_peek(leituras, SLOTS);
+    CHECAR(n == pendentes);
+    for (size_t i = 0; i < n; i++) {
+        CHECAR(leituras[i].uptime_s != sem_commit && leituras[i].uptime_s != corrompida);
+        fprintf(f, "%lu %u\n", (unsigned long)leituras[i].uptime_s, (unsigned)leituras[i].basculadas);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    testar_voltas();
+    testar_remontagem();
+    testar_commit_ausente();
+    testar_crc();
+    testar_estouro();
+    if (argc > 1 && !gravar_imagem(argv[1])) {
+        falhas++;
+    }
+
+    if (falhas > 0) {
+        printf("%d falhas\n", falhas);
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+// Reprodução de traços de bordas do sensor: compara as basculadas perdidas pelo
+// caminho por interrupção (cada borda com horário, pelo debounce_edge) com as do
+// polling antigo, que lia o pino a cada 100 ms e contava as mudanças de nível.
+//
+// Sem argumentos, roda traços sintéticos de chuva leve e de tempestade e confere as
+// perdas de cada caminho. Com um arquivo, reproduz um traço gravado: uma borda por
+// linha, "t_us nivel", em ordem de tempo, com o contato aberto antes da primeira;
+// linhas com '#' são comentários.
+//
+// Uso: pluvio_core_replay [traço]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debounce.h"
+
+#define POLL_PERIODO_US 100000  // vTaskDelay(100 ms) do sensor_task original
+#define NIVEL_ATIVO 0           // Reed switch para o GND com pull-up
+#define BORDAS_MAX 65536
+
+typedef struct {
+    int64_t t_us;
+    int nivel;
+} borda_t;
+
+typedef struct {
+    borda_t bordas[BORDAS_MAX];
+    size_t n;
+    uint32_t basculadas;  // Pulsos reais no traço, para os sintéticos
+} traco_t;
+
+static int falhas = 0;
+
+#define CHECAR(cond) do { \
+    if (!(cond)) { \
+        printf("FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        falhas++; \
+    } \
+} while (0)
+
+static void acrescentar(traco_t *t, int64_t t_us, int nivel) {
+    if (t->n < BORDAS_MAX) {
+        t->bordas[t->n++] = (borda_t){ t_us, nivel };
+    }
+}
+
+// Uma basculada: o contato fecha em inicio_us e abre largura_us depois, trepidando
+// trepidacoes vezes em cada transição (pulsos de 300 us a cada 700 us)
+static void acrescentar_basculada(traco_t *t, int64_t inicio_us, int64_t largura_us, int trepidacoes) {
+    for (int i = 0; i < trepidacoes; i++) {
+        acrescentar(t, inicio_us + i * 700, NIVEL_ATIVO);
+        acrescentar(t, inicio_us + i * 700 + 300, !NIVEL_ATIVO);
+    }
+    acrescentar(t, inicio_us + trepidacoes * 700, NIVEL_ATIVO);
+    int64_t fim_us = inicio_us + largura_us;
+    acrescentar(t, fim_us, !NIVEL_ATIVO);
+    for (int i = 0; i < trepidacoes; i++) {
+        acrescentar(t, fim_us + 400 + i * 700, NIVEL_ATIVO);
+        acrescentar(t, fim_us + 600 + i * 700, !NIVEL_ATIVO);
+    }
+    t->basculadas++;
+}
+
+// n basculadas a cada periodo_us, com o início deslocado de forma irregular em relação
+// ao relógio do polling, como numa gravação real
+static void gerar(traco_t *t, uint32_t n, int64_t periodo_us, int64_t largura_us, int trepidacoes) {
+    t->n = 0;
+    t->basculadas = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t inicio_us = 1000000 + (int64_t)i * periodo_us + (int64_t)(i * 7919 % 100) * 1000 + 137;
+        acrescentar_basculada(t, inicio_us, largura_us, trepidacoes);
+    }
+}
+
+// Caminho por interrupção: todas as bordas, com horário, pelo filtro do firmware
+// (padrões do menuconfig)
+static uint32_t contar_isr(const traco_t *t) {
+    const debounce_config_t cfg = {
+        .largura_min_us = 5000,
+        .refratario_us = 50000,
+        .taxa_max_por_min = 120,
+        .nivel_ativo = NIVEL_ATIVO,
+    };
+    debounce_t d;
+    debounce_init(&d, &cfg);
+    uint32_t basculadas = 0;
+    for (size_t i = 0; i < t->n; i++) {
+        basculadas += debounce_edge(&d, t->bordas[i].t_us, t->bordas[i].nivel);
+    }
+    return basculadas;
+}
+
+// Polling antigo: o nível do pino a cada POLL_PERIODO_US. Ele contava as duas
+// mudanças de cada pulso; aqui conta só a entrada no nível ativo, uma por basculada,
+// para comparar só as perdas.
+static uint32_t contar_polling(const traco_t *t) {
+    if (t->n == 0) {
+        return 0;
+    }
+    int nivel = !NIVEL_ATIVO;
+    int anterior = nivel;
+    size_t proxima = 0;
+    uint32_t basculadas = 0;
+    int64_t fim_us = t->bordas[t->n - 1].t_us + POLL_PERIODO_US;
+    for (int64_t amostra_us = 0; amostra_us <= fim_us; amostra_us += POLL_PERIODO_US) {
+        while (proxima < t->n && t->bordas[proxima].t_us <= amostra_us) {
+            nivel = t->bordas[proxima++].nivel;
+        }
+        if (nivel == NIVEL_ATIVO && anterior != NIVEL_ATIVO) {
+            basculadas++;
+        }
+        anterior = nivel;
+    }
+    return basculadas;
+}
+
+static void relatar(const char *nome, uint32_t reais, uint32_t isr, uint32_t polling) {
+    if (reais == 0) {
+        printf("%-28s nenhuma basculada\n", nome);
+        return;
+    }
+    printf("%-28s %5u basculadas  interrupção %5u (%5.1f%% perdidas)  polling 100 ms %5u (%5.1f%% perdidas)\n",
+           nome, (unsigned)reais, (unsigned)isr, 100.0 * ((double)reais - isr) / reais, (unsigned)polling,
+           100.0 * ((double)reais - polling) / reais);
+}
+
+static traco_t traco;
+
+static void testar_sinteticos(void) {
+    // Chuva leve: pulsos de 150 ms, mais longos que o período do polling
+    gerar(&traco, 50, 60000000, 150000, 2);
+    uint32_t isr = contar_isr(&traco);
+    uint32_t polling = contar_polling(&traco);
+    relatar("chuva leve, pulsos de 150 ms", traco.basculadas, isr, polling);
+    CHECAR(isr == traco.basculadas);
+    CHECAR(polling == traco.basculadas);
+
+    // Tempestade: uma basculada a cada 1,5 s e o ímã passa mais rápido pelo reed,
+    // pulsos de 40 ms. O polling só vê os que caem sobre uma amostra: 40 ms de 100.
+    gerar(&traco, 200, 1500000, 40000, 3);
+    isr = contar_isr(&traco);
+    polling = contar_polling(&traco);
+    relatar("tempestade, pulsos de 40 ms", traco.basculadas, isr, polling);
+    CHECAR(isr == traco.basculadas);
+    CHECAR(polling == 80);
+
+    // Pulsos de 10 ms, ainda acima da largura mínima do filtro: o polling vê 1 em 10
+    gerar(&traco, 200, 1000000, 10000, 3);
+    isr = contar_isr(&traco);
+    polling = contar_polling(&traco);
+    relatar("tempestade, pulsos de 10 ms", traco.basculadas, isr, polling);
+    CHECAR(isr == traco.basculadas);
+    CHECAR(polling == 20);
+}
+
+static bool ler_traco(const char *caminho, traco_t *t) {
+    FILE *f = fopen(caminho, "r");
+    if (f == NULL) {
+        perror(caminho);
+        return false;
+    }
+    char linha[128];
+    t->n = 0;
+    while (fgets(linha, sizeof(linha), f) != NULL) {
+        long long t_us;
+        int nivel;
+        if (linha[0] != '#' && sscanf(linha, "%lld %d", &t_us, &nivel) == 2) {
+            acrescentar(t, t_us, nivel != 0);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        if (!ler_traco(argv[1], &traco)) {
+            return EXIT_FAILURE;
+        }
+        // Sem o número real de basculadas, o caminho por interrupção é a referência
+        uint32_t isr = contar_isr(&traco);
+        relatar(argv[1], isr, isr, contar_polling(&traco));
+        return EXIT_SUCCESS;
+    }
+
+    testar_sinteticos();
+    if (falhas > 0) {
+        printf("%d falhas\n", falhas);
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,519 @@
+// Testes do pluvio_core no host: os mesmos arquivos do firmware, sem hardware.
+// Cada módulo é exercitado pelos casos que o firmware depende: trepidação do reed
+// switch, acumulador disputado por duas threads, contador falso pela interface dos
+// backends, anel cheio, janelas da agregação, níveis do intervalo de envio, formatos
+// do envio, backoff do WiFi e modelo do contador do ULP.
+//
+// Uso: pluvio_core_test
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debounce.h"
+#include "rain_agg.h"
+#include "report_sched.h"
+#include "tip_accum.h"
+#include "tip_counter_fake.h"
+#include "tip_ring.h"
+#include "uplink_batch.h"
+#include "uplink_bin.h"
+#include "uplink_codec.h"
+#include "ulp_tips.h"
+#include "wifi_sm.h"
+
+static int falhas = 0;
+
+#define CHECAR(cond) do { \
+    if (!(cond)) { \
+        printf("FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        falhas++; \
+    } \
+} while (0)
+
+static void testar_debounce(void) {
+    const debounce_config_t cfg = {
+        .largura_min_us = 5000,
+        .refratario_us = 50000,
+        .taxa_max_por_min = 120,
+        .nivel_ativo = 0,
+    };
+    debounce_t d;
+    debounce_init(&d, &cfg);
+
+    // Pulso válido de 20 ms, contado na liberação
+    CHECAR(!debounce_edge(&d, 1000000, 0));
+    CHECAR(debounce_edge(&d, 1020000, 1));
+
+    // Trepidação logo depois da liberação cai no refratário
+    CHECAR(!debounce_edge(&d, 1030000, 0));
+    CHECAR(!debounce_edge(&d, 1031000, 1));
+    CHECAR(d.rejeitadas_refratario == 1);
+
+    // Pulso curto demais
+    CHECAR(!debounce_edge(&d, 2000000, 0));
+    CHECAR(!debounce_edge(&d, 2001000, 1));
+    CHECAR(d.rejeitadas_curtas == 1);
+
+    // Acima de 120 por minuto (menos de 500 ms desde a última aceita)
+    debounce_init(&d, &cfg);
+    CHECAR(!debounce_edge(&d, 0, 0));
+    CHECAR(debounce_edge(&d, 10000, 1));
+    CHECAR(!debounce_edge(&d, 300000, 0));
+    CHECAR(!debounce_edge(&d, 310000, 1));
+    CHECAR(d.rejeitadas_taxa == 1);
+    CHECAR(!debounce_edge(&d, 600000, 0));
+    CHECAR(debounce_edge(&d, 610000, 1));
+    CHECAR(d.aceitas == 2);
+}
+
+// Forma de onda de um reed switch que trepida: cada basculada fecha o contato com
+// trepidacoes pulsos de 200 us antes de firmar e o abre com outros tantos depois
+static uint32_t basculadas_trepidando(debounce_t *d, int64_t inicio_us, uint32_t n, int64_t periodo_us,
+                                      int64_t largura_us, int trepidacoes) {
+    uint32_t contadas = 0;
+    int ativo = d->cfg.nivel_ativo;
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t t = inicio_us + (int64_t)i * periodo_us;
+        for (int k = 0; k < trepidacoes; k++, t += 500) {
+            contadas += debounce_edge(d, t, ativo);
+            contadas += debounce_edge(d, t + 200, !ativo);
+        }
+        contadas += debounce_edge(d, t, ativo);
+        t += largura_us;
+        contadas += debounce_edge(d, t, !ativo);
+        for (int k = 0; k < trepidacoes; k++) {
+            t += 500;
+            contadas += debounce_edge(d, t, ativo);
+            contadas += debounce_edge(d, t + 200, !ativo);
+        }
+    }
+    return contadas;
+}
+
+static void testar_debounce_trepidacao(void) {
+    const debounce_config_t cfg = {
+        .largura_min_us = 5000,
+        .refratario_us = 50000,
+        .taxa_max_por_min = 120,
+        .nivel_ativo = 0,
+    };
+    debounce_t d;
+
+    // Contato limpo e contato com 1, 4 e 10 trepidações em cada transição: sempre uma
+    // basculada por pulso. A trepidação do fechamento é curta demais; a da abertura
+    // cai no refratário.
+    const int trepidacoes[] = { 0, 1, 4, 10 };
+    for (size_t i = 0; i < sizeof(trepidacoes) / sizeof(trepidacoes[0]); i++) {
+        debounce_init(&d, &cfg);
+        int k = trepidacoes[i];
+        CHECAR(basculadas_trepidando(&d, 1000000, 50, 2000000, 60000, k) == 50);
+        CHECAR(d.aceitas == 50);
+        CHECAR(d.rejeitadas_curtas == 50u * k);
+        CHECAR(d.rejeitadas_refratario == 50u * k);
+        CHECAR(d.rejeitadas_taxa == 0);
+    }
+
+    // Mesma trepidação a 240 por minuto, o dobro do plausível: metade é rejeitada pela taxa
+    debounce_init(&d, &cfg);
+    CHECAR(basculadas_trepidando(&d, 1000000, 40, 250000, 60000, 3) == 20);
+    CHECAR(d.rejeitadas_taxa == 20);
+
+    // Só trepidação, sem nenhum pulso longo: nada é contado
+    debounce_init(&d, &cfg);
+    CHECAR(basculadas_trepidando(&d, 1000000, 20, 1000000, 1000, 5) == 0);
+    CHECAR(d.aceitas == 0);
+}
+
+static void testar_tip_ring(void) {
+    uint32_t armazenamento[8];
+    uint32_t saida[8];
+    tip_ring_t ring;
+
+    CHECAR(!tip_ring_init(&ring, armazenamento, 6));
+    CHECAR(tip_ring_init(&ring, armazenamento, 8));
+
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECAR(tip_ring_push(&ring, i));
+    }
+    CHECAR(!tip_ring_push(&ring, 99));
+    CHECAR(tip_ring_dropped(&ring) == 1);
+    CHECAR(tip_ring_high_water(&ring) == 8);
+
+    CHECAR(tip_ring_pop_many(&ring, saida, 3) == 3);
+    CHECAR(saida[0] == 0 && saida[2] == 2);
+    // Volta no anel
+    for (uint32_t i = 8; i < 11; i++) {
+        CHECAR(tip_ring_push(&ring, i));
+    }
+    CHECAR(tip_ring_count(&ring) == 8);
+    CHECAR(tip_ring_pop_many(&ring, saida, 8) == 8);
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECAR(saida[i] == i + 3);
+    }
+    CHECAR(tip_ring_count(&ring) == 0);
+}
+
+static void testar_tip_accum(void) {
+    tip_accum_t acc = TIP_ACCUM_INIT;
+    tip_accum_add(&acc, 0, 3);
+    tip_accum_add(&acc, 1, 2);
+    tip_accum_add(&acc, 7, 1);  // Shard fora da faixa cai em shard % TIP_ACCUM_SHARDS
+    CHECAR(tip_accum_peek(&acc) == 6);
+    CHECAR(tip_accum_take(&acc) == 6);
+    CHECAR(tip_accum_take(&acc) == 0);
+}
+
+// Estresse entre threads: uma soma como o sensor, nos dois shards, e a outra recolhe
+// como o envio. Tudo o que foi somado aparece em exatamente um take.
+#define ACUMULADOR_SOMAS 2000000
+
+typedef struct {
+    tip_accum_t acc;
+    atomic_bool terminou;
+    uint64_t recolhido;
+} acumulador_estresse_t;
+
+static void *somar_basculadas(void *arg) {
+    acumulador_estresse_t *a = arg;
+    for (uint32_t i = 0; i < ACUMULADOR_SOMAS; i++) {
+        tip_accum_add(&a->acc, i & 1, 1);
+    }
+    atomic_store_explicit(&a->terminou, true, memory_order_release);
+    return NULL;
+}
+
+static void *recolher_basculadas(void *arg) {
+    acumulador_estresse_t *a = arg;
+    while (!atomic_load_explicit(&a->terminou, memory_order_acquire)) {
+        a->recolhido += tip_accum_take(&a->acc);
+        sched_yield();  // Também avança com uma CPU só
+    }
+    return NULL;
+}
+
+static void testar_tip_accum_threads(void) {
+    static acumulador_estresse_t a;  // Zerado, como TIP_ACCUM_INIT
+    pthread_t somador, recolhedor;
+    CHECAR(pthread_create(&recolhedor, NULL, recolher_basculadas, &a) == 0);
+    CHECAR(pthread_create(&somador, NULL, somar_basculadas, &a) == 0);
+    pthread_join(somador, NULL);
+    pthread_join(recolhedor, NULL);
+    a.recolhido += tip_accum_take(&a.acc);
+    CHECAR(a.recolhido == ACUMULADOR_SOMAS);
+}
+
+// Um envio pela interface dos backends, como o da sensor_task: lê e zera a contagem e
+// soma no agregador
+static uint32_t coletar(const tip_counter_backend_t *backend, rain_agg_t *agg, uint32_t agora_s) {
+    uint32_t basculadas = backend->take();
+    rain_agg_add(agg, agora_s, basculadas);
+    return basculadas;
+}
+
+static void testar_tip_counter_fake(void) {
+    const tip_counter_backend_t *backend = &tip_counter_fake;
+    tip_counter_fake_reiniciar(-1);
+    CHECAR(backend->init(4) != 0);
+    CHECAR(tip_counter_fake_pino() == -1);
+
+    tip_counter_fake_reiniciar(0);
+    CHECAR(backend->init(4) == 0);
+    CHECAR(tip_counter_fake_pino() == 4);
+    CHECAR(backend->run == NULL);  // Conta sozinho: a sensor_task não fica em laço
+
+    rain_agg_t agg;
+    rain_agg_init(&agg, 1630);
+    tip_counter_fake_basculadas(2);
+    tip_counter_fake_basculadas(3);
+    CHECAR(coletar(backend, &agg, 100) == 5);
+    CHECAR(coletar(backend, &agg, 160) == 0);
+    tip_counter_fake_basculadas(1);
+    CHECAR(coletar(backend, &agg, 220) == 1);
+    CHECAR(agg.soma.total_1h == 6);
+
+    backend->despertar_apos(8);
+    CHECAR(tip_counter_fake_despertar() == 8);
+}
+
+static void testar_rain_agg(void) {
+    rain_agg_t agg;
+    rain_agg_init(&agg, 200);  // 0,2 mm por basculada
+
+    rain_agg_add(&agg, 1000, 1);
+    rain_agg_add(&agg, 1030, 2);
+    CHECAR(agg.soma.total_1min == 3);
+    CHECAR(agg.soma.total_10min == 3);
+
+    // 1 min depois a primeira basculada saiu da janela de 1 min
+    rain_agg_advance(&agg, 1061);
+    CHECAR(agg.soma.total_1min == 2);
+    CHECAR(agg.soma.total_1h == 3);
+
+    // Depois de 10 min só sobra na janela de 1 h
+    rain_agg_advance(&agg, 1000 + 11 * 60);
+    CHECAR(agg.soma.total_10min == 0);
+    CHECAR(agg.soma.total_1h == 3);
+    CHECAR(agg.maximo.total_10min == 3);
+
+    // Lacuna maior que 24 h zera tudo
+    rain_agg_advance(&agg, 1000 + 25 * 3600);
+    CHECAR(agg.soma.total_24h == 0);
+
+    // Instante atrasado entra no balde atual
+    rain_agg_add(&agg, 500, 1);
+    CHECAR(agg.soma.total_1min == 1);
+
+    CHECAR(rain_agg_mm(&agg, 5) > 0.999f && rain_agg_mm(&agg, 5) < 1.001f);
+    CHECAR(rain_agg_mm_h(&agg, 1, 60) > 11.99f && rain_agg_mm_h(&agg, 1, 60) < 12.01f);
+}
+
+static void testar_report_sched(void) {
+    const report_sched_config_t cfg = {
+        .intervalo_seco_s = 900,
+        .intervalo_chuva_s = 300,
+        .intervalo_forte_s = 60,
+        .limiar_chuva = 2,
+        .limiar_forte = 20,
+        .calmaria_s = 1800,
+    };
+    report_sched_t s;
+    report_sched_init(&s, &cfg, 10000);
+
+    // Primeiro envio após o intervalo mais curto
+    CHECAR(report_sched_faltam_s(&s, 10000) == 60);
+    report_sched_enviado(&s, 10060);
+    CHECAR(report_sched_faltam_s(&s, 10060) == 900);
+
+    CHECAR(report_sched_atualizar(&s, 10100, 5) == REPORT_CHUVA);
+    CHECAR(report_sched_intervalo_s(&s) == 300);
+    CHECAR(report_sched_proximo_limiar(&s) == 20);
+    CHECAR(report_sched_atualizar(&s, 10200, 25) == REPORT_FORTE);
+
+    // Calmaria: cada nível vale até calmaria_s depois da última taxa que o justificou
+    CHECAR(report_sched_atualizar(&s, 10300, 5) == REPORT_FORTE);
+    CHECAR(report_sched_atualizar(&s, 10200 + 1800, 0) == REPORT_CHUVA);
+    CHECAR(report_sched_atualizar(&s, 10300 + 1800, 0) == REPORT_SECO);
+}
+
+static void testar_uplink_batch(void) {
+    leitura_t leituras[2];
+    memset(leituras, 0, sizeof(leituras));
+    leituras[0].campos[0] = 1.25f;
+    leituras[1].campos[0] = 0.2f;
+    leituras[1].campos[5] = -3.5f;
+    const uint32_t epochs[2] = { 1704067199, 0 };  // 2023-12-31T23:59:59Z
+    char buf[600];
+
+    size_t len = uplink_batch_encode(buf, sizeof(buf), "CHAVE", leituras, epochs, 2, "cpu:1/0");
+    CHECAR(len == strlen(buf));
+    CHECAR(strcmp(buf,
+                  "{\"write_api_key\":\"CHAVE\",\"updates\":["
+                  "{\"created_at\":\"2023-12-31T23:59:59Z\",\"field1\":1.25,\"field2\":0.00,\"field3\":0.00,"
+                  "\"field4\":0.00,\"field5\":0.00,\"field6\":0.00},"
+                  "{\"field1\":0.20,\"field2\":0.00,\"field3\":0.00,\"field4\":0.00,\"field5\":0.00,"
+                  "\"field6\":-3.50,\"status\":\"cpu:1/0\"}]}") == 0);
+
+    // Sem espaço: nada escrito
+    CHECAR(uplink_batch_encode(buf, len, "CHAVE", leituras, epochs, 2, "cpu:1/0") == 0);
+    CHECAR(uplink_batch_encode(buf, len + 1, "CHAVE", leituras, epochs, 2, "cpu:1/0") == len);
+
+    // O dimensionamento declarado no cabeçalho cobre o pior caso
+    for (int i = 0; i < LEITURA_CAMPOS; i++) {
+        leituras[0].campos[i] = -42949672.0f;
+    }
+    const uint32_t epoch_max[1] = { 0xFFFFFFFF };
+    char status[32];
+    memset(status, 'x', sizeof(status) - 1);
+    status[sizeof(status) - 1] = '\0';
+    char justo[UPLINK_BATCH_BYTES_FIXOS + UPLINK_BATCH_BYTES_POR_LEITURA + UPLINK_BATCH_BYTES_STATUS + 31];
+    CHECAR(uplink_batch_encode(justo, sizeof(justo), "0123456789ABCDEF", leituras, epoch_max, 1, status) > 0);
+}
+
+static void testar_uplink_codec(void) {
+    leitura_t leituras[3];
+    memset(leituras, 0, sizeof(leituras));
+    leituras[0].campos[0] = 12.34f;
+    leituras[0].campos[5] = 100.0f;
+    leituras[0].basculadas = 7;
+    leituras[1].campos[2] = -0.5f;
+    leituras[2].basculadas = 300;
+    uint32_t epochs[3] = { 1704067199, 0, 1704067499 };
+    uint8_t buf[UPLINK_BIN_BYTES(3)];
+
+    // Formulário: o mesmo texto do snprintf("&field1=%.2f...") de antes da interface
+    uplink_lote_t lote = { "CHAVE", leituras, epochs, 1, "cpu:1/0" };
+    size_t len = uplink_codec_form.codificar(buf, sizeof(buf), &lote);
+    CHECAR(len == strlen((char *)buf));
+    CHECAR(strcmp((char *)buf, "&field1=12.34&field2=0.00&field3=0.00&field4=0.00&field5=0.00&field6=100.00"
+                               "&created_at=2023-12-31T23:59:59Z&status=cpu:1/0") == 0);
+    lote.n = 2;
+    CHECAR(uplink_codec_form.codificar(buf, sizeof(buf), &lote) == 0);
+
+    // JSON: o mesmo do uplink_batch_encode
+    char esperado[600];
+    lote.n = 3;
+    len = uplink_codec_json.codificar(buf, sizeof(buf), &lote);
+    CHECAR(len > 0 && len == uplink_batch_encode(esperado, sizeof(esperado), "CHAVE", leituras, epochs, 3,
+                                                 "cpu:1/0"));
+    CHECAR(memcmp(buf, esperado, len) == 0);
+
+    // Binário: ida e volta, com epochs que sobem, voltam a 0 e sobem de novo
+    len = uplink_codec_bin.codificar(buf, sizeof(buf), &lote);
+    CHECAR(len > 0 && len < 60);
+    CHECAR(buf[0] == 'P' && buf[1] == 'L' && buf[2] == UPLINK_BIN_VERSAO && buf[3] == 3);
+    leitura_t lidas[3];
+    uplink_bin_cabecalho_t cab;
+    CHECAR(uplink_bin_decodificar(buf, len, &cab, lidas, 3));
+    CHECAR(cab.n == 3);
+    CHECAR(cab.chave_len == 5 && memcmp(cab.chave, "CHAVE", 5) == 0);
+    CHECAR(cab.status_len == 7 && memcmp(cab.status, "cpu:1/0", 7) == 0);
+    for (size_t i = 0; i < 3; i++) {
+        CHECAR(lidas[i].epoch_s == epochs[i]);
+        CHECAR(lidas[i].basculadas == leituras[i].basculadas);
+        for (int campo = 0; campo < LEITURA_CAMPOS; campo++) {
+            float erro = lidas[i].campos[campo] - leituras[i].campos[campo];
+            CHECAR(erro > -0.006f && erro < 0.006f);
+        }
+    }
+
+    // Dados truncados, sobrando ou de outra versão são recusados
+    CHECAR(!uplink_bin_decodificar(buf, len - 1, &cab, lidas, 3));
+    CHECAR(!uplink_bin_decodificar(buf, len + 1, &cab, lidas, 3));
+    CHECAR(!uplink_bin_decodificar(buf, len, &cab, lidas, 2));
+    buf[2]++;
+    CHECAR(!uplink_bin_decodificar(buf, len, &cab, lidas, 3));
+
+    // Sem espaço: nada escrito; o dimensionamento do cabeçalho cobre o pior caso
+    CHECAR(uplink_codec_bin.codificar(buf, len - 1, &lote) == 0);
+    for (int i = 0; i < LEITURA_CAMPOS; i++) {
+        leituras[0].campos[i] = -42949672.0f;
+    }
+    leituras[0].basculadas = UINT16_MAX;
+    epochs[0] = 0xFFFFFFFF;
+    char texto[UPLINK_BIN_STATUS_MAX + 1];
+    memset(texto, 'x', sizeof(texto) - 1);
+    texto[sizeof(texto) - 1] = '\0';
+    uplink_lote_t pior = { texto, leituras, epochs, 1, texto };
+    uint8_t justo[UPLINK_BIN_BYTES(1)];
+    CHECAR(uplink_codec_bin.codificar(justo, sizeof(justo), &pior) > 0);
+}
+
+// n leituras seguidas do pino no mesmo nível; retorna quantas acordariam o processador
+static int ulp_amostras(ulp_tips_modelo_t *m, int nivel, int n, bool dormindo) {
+    int despertares = 0;
+    for (int i = 0; i < n; i++) {
+        despertares += ulp_tips_amostrar(m, nivel, dormindo);
+    }
+    return despertares;
+}
+
+static void testar_ulp_tips(void) {
+    ulp_tips_modelo_t m;
+
+    // Reed para o GND (ativo em 0), pino em repouso em 1; nível novo aceito na
+    // debounce_max + 1ª leitura seguida
+    ulp_tips_modelo_init(&m, 1, 0, 2);
+    CHECAR(m.nivel_esperado == 0);
+
+    // Trepidação mais curta que o debounce: nem o fechamento é aceito
+    CHECAR(ulp_amostras(&m, 0, 2, true) == 0);
+    CHECAR(ulp_amostras(&m, 1, 1, true) == 0);
+    CHECAR(m.nivel_esperado == 0 && m.basculadas == 0);
+    CHECAR(m.debounce_contador == m.debounce_max);
+
+    // Fechamento firme: aceito, mas não conta
+    CHECAR(ulp_amostras(&m, 0, 3, true) == 0);
+    CHECAR(m.nivel_esperado == 1 && m.basculadas == 0);
+
+    // Trepidação na abertura também é descartada; só a liberação firme conta
+    CHECAR(ulp_amostras(&m, 1, 2, true) == 0);
+    CHECAR(ulp_amostras(&m, 0, 1, true) == 0);
+    CHECAR(m.basculadas == 0);
+    CHECAR(ulp_amostras(&m, 1, 3, true) == 0);
+    CHECAR(m.basculadas == 1 && m.nivel_esperado == 0);
+
+    // Acorda exatamente quando basculadas chega a limite, e só com o processador dormindo
+    m.limite = ulp_tips_limite(m.basculadas, 2);
+    CHECAR(m.limite == 3);
+    CHECAR(ulp_amostras(&m, 0, 3, true) == 0);
+    CHECAR(ulp_amostras(&m, 1, 3, true) == 0);  // 2 basculadas
+    CHECAR(ulp_amostras(&m, 0, 3, false) == 0);
+    CHECAR(ulp_amostras(&m, 1, 3, false) == 0);  // 3 = limite, mas acordado
+    CHECAR(m.basculadas == 3);
+    m.limite = ulp_tips_limite(m.basculadas, 1);
+    CHECAR(ulp_amostras(&m, 0, 3, true) == 0);   // O fechamento não acorda
+    CHECAR(ulp_tips_amostrar(&m, 1, true) == false);
+    CHECAR(ulp_tips_amostrar(&m, 1, true) == false);
+    CHECAR(ulp_tips_amostrar(&m, 1, true) == true);  // Na leitura que aceita a liberação
+    CHECAR(ulp_amostras(&m, 0, 3, true) == 0);
+    CHECAR(ulp_amostras(&m, 1, 3, true) == 0);   // Passou do limite
+    CHECAR(m.basculadas == 5);
+
+    // Ativo em 1: a liberação é a descida
+    ulp_tips_modelo_init(&m, 0, 1, 0);
+    CHECAR(ulp_amostras(&m, 1, 1, true) == 0 && m.basculadas == 0);
+    CHECAR(ulp_amostras(&m, 0, 1, true) == 0 && m.basculadas == 1);
+
+    // Contadores de 16 bits do ULP
+    uint16_t anterior = 65530;
+    CHECAR(ulp_tips_delta(4, &anterior) == 10);
+    CHECAR(anterior == 4);
+    CHECAR(ulp_tips_delta(4, &anterior) == 0);
+    CHECAR(ulp_tips_limite(10, 0) == 11);           // Pelo menos mais uma
+    CHECAR(ulp_tips_limite(10, 70000) == 9);        // No máximo 65535 adiante
+    CHECAR(ulp_tips_limite(65535, 1) == 0);
+}
+
+static void testar_wifi_sm(void) {
+    const wifi_sm_config_t cfg = { .base_ms = 1000, .max_ms = 8000, .max_falhas = 6 };
+    wifi_sm_t sm;
+    wifi_sm_init(&sm, &cfg, 1234);
+
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_INICIAR) == WIFI_SM_ACAO_CONECTAR);
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_INICIAR) == WIFI_SM_ACAO_NENHUMA);
+
+    // Espera cresce até o teto, sempre entre metade e o valor cheio
+    uint32_t teto = 1000;
+    for (int falha = 1; falha < 6; falha++) {
+        CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_DESCONECTOU) == WIFI_SM_ACAO_AGENDAR);
+        CHECAR(sm.espera_ms >= teto / 2 && sm.espera_ms <= teto);
+        CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_DESCONECTOU) == WIFI_SM_ACAO_NENHUMA);  // Evento atrasado
+        CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_TIMER) == WIFI_SM_ACAO_CONECTAR);
+        teto = teto * 2 > 8000 ? 8000 : teto * 2;
+    }
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_DESCONECTOU) == WIFI_SM_ACAO_DESISTIR);
+    CHECAR(sm.estado == WIFI_SM_DESISTIU);
+
+    // Retomada, IP e perda do link: reconecta na hora, sem espera
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_INICIAR) == WIFI_SM_ACAO_CONECTAR);
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_CONECTOU) == WIFI_SM_ACAO_NENHUMA);
+    CHECAR(wifi_sm_evento(&sm, WIFI_SM_EV_DESCONECTOU) == WIFI_SM_ACAO_CONECTAR);
+    CHECAR(sm.falhas == 0);
+}
+
+int main(void) {
+    testar_debounce();
+    testar_debounce_trepidacao();
+    testar_tip_ring();
+    testar_tip_accum();
+    testar_tip_accum_threads();
+    testar_tip_counter_fake();
+    testar_rain_agg();
+    testar_report_sched();
+    testar_uplink_batch();
+    testar_uplink_codec();
+    testar_ulp_tips();
+    testar_wifi_sm();
+
+    if (falhas > 0) {
+        printf("%d falhas\n", falhas);
+        return EXIT_FAILURE;
+    }
+    printf("ok\n");
+    return EXIT_SUCCESS;
+}
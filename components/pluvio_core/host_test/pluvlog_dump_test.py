@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+# Confere o tools/pluvlog_dump.py contra a imagem gravada pelo offline_log_test: as
+# leituras pendentes listadas, na ordem de envio, e a contagem de cada estado.
+#
+# Uso: pluvlog_dump_test.py pluvlog_dump.py imagem    # Lê imagem.esperado ao lado
+
+import re
+import subprocess
+import sys
+
+
+def main():
+    dump, imagem = sys.argv[1:3]
+    with open(imagem + '.esperado') as f:
+        linhas = f.read().splitlines()
+    contagem = {nome: int(valor) for nome, valor in (linha.split() for linha in linhas[:3])}
+    esperadas = [tuple(int(v) for v in linha.split()) for linha in linhas[3:]]
+
+    saida = subprocess.run([sys.executable, dump, imagem], capture_output=True, text=True, check=True)
+    listadas = [(int(m.group(1)), int(m.group(2)))
+                for m in re.finditer(r'pendente +boot \d+ \+ (\d+) s +basculadas=(\d+)', saida.stdout)]
+    resumo = f'{contagem["pendentes"]} pendentes, {contagem["enviados"]} enviados, ' \
+             f'{contagem["invalidos"]} inválidos'
+
+    falhas = 0
+    if listadas != esperadas:
+        print(f'FALHA: {len(listadas)} pendentes listadas, {len(esperadas)} esperadas')
+        falhas += 1
+    if resumo not in saida.stderr:
+        print(f'FALHA: resumo "{saida.stderr.strip()}", esperado "{resumo}"')
+        falhas += 1
+    print(f'{falhas} falhas' if falhas else 'ok')
+    sys.exit(1 if falhas else 0)
+
+
+if __name__ == '__main__':
+    main()
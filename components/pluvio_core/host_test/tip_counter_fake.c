@@ -0,0 +1,52 @@
+#include <stddef.h>
+
+#include "tip_accum.h"
+#include "tip_counter_fake.h"
+
+static tip_accum_t contagem = TIP_ACCUM_INIT;
+static int erro_init = 0;
+static int pino = -1;
+static uint32_t despertar = 0;
+
+void tip_counter_fake_reiniciar(int erro) {
+    tip_accum_take(&contagem);
+    erro_init = erro;
+    pino = -1;
+    despertar = 0;
+}
+
+void tip_counter_fake_basculadas(uint32_t n) {
+    tip_accum_add(&contagem, 0, n);
+}
+
+int tip_counter_fake_pino(void) {
+    return pino;
+}
+
+uint32_t tip_counter_fake_despertar(void) {
+    return despertar;
+}
+
+static int fake_init(int p) {
+    if (erro_init != 0) {
+        return erro_init;
+    }
+    pino = p;
+    return 0;
+}
+
+static uint32_t fake_take(void) {
+    return tip_accum_take(&contagem);
+}
+
+static void fake_despertar_apos(uint32_t basculadas) {
+    despertar = basculadas;
+}
+
+const tip_counter_backend_t tip_counter_fake = {
+    .nome = "fake",
+    .init = fake_init,
+    .run = NULL,
+    .take = fake_take,
+    .despertar_apos = fake_despertar_apos,
+};
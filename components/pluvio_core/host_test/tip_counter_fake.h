@@ -0,0 +1,22 @@
+#ifndef TIP_COUNTER_FAKE_H
+#define TIP_COUNTER_FAKE_H
+
+#include <stdint.h>
+
+#include "tip_counter_backend.h"
+
+// Contador falso para os testes no host, com a mesma interface dos backends do
+// firmware. Conta sozinho como o PCNT (run é NULL): o teste faz o papel do hardware.
+extern const tip_counter_backend_t tip_counter_fake;
+
+// Estado inicial; init passa a retornar erro (0 = sucesso)
+void tip_counter_fake_reiniciar(int erro_init);
+
+// n basculadas contadas pelo "hardware". Pode ser chamada de outra thread.
+void tip_counter_fake_basculadas(uint32_t n);
+
+// O que o backend recebeu pela interface
+int tip_counter_fake_pino(void);                // -1 antes do init
+uint32_t tip_counter_fake_despertar(void);      // Último despertar_apos; 0 se nenhum
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Filtro de ruído do reed switch: transforma bordas brutas em basculadas.
+// Uma basculada é um pulso completo no nível ativo (fecha e abre o contato),
+// contado na borda de liberação. O(1) por borda e sem chamadas ao sistema,
+// então pode rodar dentro da ISR e também no host.
+typedef struct {
+    uint32_t largura_min_us;     // Pulsos mais curtos são considerados trepidação
+    uint32_t refratario_us;      // Bordas logo após uma basculada aceita são ignoradas
+    uint32_t taxa_max_por_min;   // Acima desta taxa a basculada não é fisicamente plausível (0 = sem limite)
+    int nivel_ativo;             // Nível do pino com o contato fechado
+} debounce_config_t;
+
+typedef struct {
+    debounce_config_t cfg;
+    uint32_t intervalo_min_us;   // Derivado de taxa_max_por_min
+    int64_t inicio_pulso_us;
+    int64_t ultima_aceita_us;
+    bool em_pulso;
+    bool tem_aceita;
+
+    // Contadores de diagnóstico
+    uint32_t aceitas;
+    uint32_t rejeitadas_curtas;
+    uint32_t rejeitadas_refratario;
+    uint32_t rejeitadas_taxa;
+} debounce_t;
+
+void debounce_init(debounce_t *d, const debounce_config_t *cfg);
+
+// Processa uma borda; retorna true quando ela completa uma basculada válida
+bool debounce_edge(debounce_t *d, int64_t timestamp_us, int nivel);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef LEITURA_H
+#define LEITURA_H
+
+#include <stdint.h>
+
+#define LEITURA_CAMPOS 6
+
+// Uma leitura agregada, como é enviada e guardada na flash quando não há WiFi.
+// O layout é gravado na partição pluvlog e lido por tools/pluvlog_dump.py.
+typedef struct {
+    uint32_t epoch_s;     // Horário UTC; 0 se o relógio ainda não estava sincronizado
+    uint32_t uptime_s;    // Segundos desde o boot em que a leitura foi feita
+    uint16_t boot;        // Número do boot, para recuperar o horário de leituras sem epoch
+    uint16_t basculadas;  // Basculadas no intervalo
+    float campos[LEITURA_CAMPOS];  // field1..field6 do ThingSpeak
+} leitura_t;
+
+#endif
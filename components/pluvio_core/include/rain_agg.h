@@ -0,0 +1,52 @@
+#ifndef RAIN_AGG_H
+#define RAIN_AGG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Agregação da chuva em janelas deslizantes de 1 min, 5 min, 10 min, 1 h e 24 h.
+// Memória constante e custo O(1) por basculada: cada resolução é um anel de baldes
+// com a soma mantida incrementalmente. A janela de 1 min tem resolução de 1 s, as de
+// 5 min a 1 h de 1 min e a de 24 h de 1 h. C puro, compila e roda igual no host.
+
+#define RAIN_AGG_SEGUNDOS 60
+#define RAIN_AGG_MINUTOS 60
+#define RAIN_AGG_HORAS 24
+
+typedef struct {
+    uint32_t total_1min;
+    uint32_t total_5min;
+    uint32_t total_10min;
+    uint32_t total_1h;
+    uint32_t total_24h;
+} rain_agg_totais_t;
+
+typedef struct {
+    uint32_t um_por_basculada;   // Calibração: micrômetros de chuva por basculada
+    uint32_t agora_s;            // Último segundo processado
+    bool iniciado;
+
+    uint32_t seg[RAIN_AGG_SEGUNDOS];
+    uint32_t min[RAIN_AGG_MINUTOS];
+    uint32_t hora[RAIN_AGG_HORAS];
+
+    rain_agg_totais_t soma;      // Basculadas em cada janela
+    rain_agg_totais_t maximo;    // Maior valor de cada janela desde o último rain_agg_reset_max()
+} rain_agg_t;
+
+void rain_agg_init(rain_agg_t *agg, uint32_t um_por_basculada);
+
+// Registra n basculadas no segundo t_s. Instantes anteriores ao último processado
+// entram no balde atual.
+void rain_agg_add(rain_agg_t *agg, uint32_t t_s, uint32_t n);
+
+// Avança o relógio até t_s, descartando o que saiu das janelas
+void rain_agg_advance(rain_agg_t *agg, uint32_t t_s);
+
+void rain_agg_reset_max(rain_agg_t *agg);
+
+// Conversões de basculadas para milímetros e para intensidade em mm/h
+float rain_agg_mm(const rain_agg_t *agg, uint32_t basculadas);
+float rain_agg_mm_h(const rain_agg_t *agg, uint32_t basculadas, uint32_t janela_s);
+
+#endif
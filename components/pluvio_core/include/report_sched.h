@@ -0,0 +1,58 @@
+#ifndef REPORT_SCHED_H
+#define REPORT_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Intervalo de envio adaptativo. Sem chuva o dispositivo só manda um sinal de vida
+// de tempos em tempos; quando a taxa de basculadas passa dos limiares o envio fica
+// mais frequente. Cada nível vale até calmaria_s depois da última vez em que a taxa
+// o justificou, o que evita oscilar no começo e no fim de uma chuva. C puro.
+
+typedef enum {
+    REPORT_SECO,
+    REPORT_CHUVA,
+    REPORT_FORTE,
+} report_nivel_t;
+
+typedef struct {
+    uint32_t intervalo_seco_s;
+    uint32_t intervalo_chuva_s;
+    uint32_t intervalo_forte_s;
+    uint32_t limiar_chuva;       // Basculadas em 10 min para entrar em chuva
+    uint32_t limiar_forte;       // Basculadas em 10 min para chuva forte
+    uint32_t calmaria_s;         // Tempo abaixo do limiar até descer de nível
+} report_sched_config_t;
+
+typedef struct {
+    report_sched_config_t cfg;
+    report_nivel_t nivel;
+    uint32_t ultimo_envio_s;
+    uint32_t chuva_em_s;         // Última vez com taxa de chuva
+    uint32_t forte_em_s;         // Última vez com taxa de chuva forte
+    bool teve_chuva;
+    bool teve_forte;
+} report_sched_t;
+
+// O primeiro envio sai após o intervalo mais curto, para confirmar logo que o
+// dispositivo está no ar; depois vale o intervalo do nível.
+void report_sched_init(report_sched_t *s, const report_sched_config_t *cfg, uint32_t agora_s);
+
+// Reavalia o nível com as basculadas dos últimos 10 min; retorna o nível novo
+report_nivel_t report_sched_atualizar(report_sched_t *s, uint32_t agora_s, uint32_t basculadas_10min);
+
+// Intervalo do nível atual e instante do próximo envio
+uint32_t report_sched_intervalo_s(const report_sched_t *s);
+uint32_t report_sched_prazo_s(const report_sched_t *s);
+
+// Segundos até o prazo; zero ou negativo quando já é hora de enviar
+int32_t report_sched_faltam_s(const report_sched_t *s, uint32_t agora_s);
+
+// Basculadas em 10 min que fariam o nível subir (0 se já está no máximo)
+uint32_t report_sched_proximo_limiar(const report_sched_t *s);
+
+void report_sched_enviado(report_sched_t *s, uint32_t agora_s);
+
+const char *report_sched_nome(report_nivel_t nivel);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TIP_ACCUM_H
+#define TIP_ACCUM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Acumulador de basculadas sem lock, compartilhado entre a task do sensor e a de envio.
+// Cada núcleo soma na sua própria parcela (shard), em linhas de cache separadas, e
+// tip_accum_take() recolhe tudo com troca atômica: nenhuma basculada é perdida nem
+// contada duas vezes, sem mutex e sem desabilitar interrupções.
+// Só usa C11, então compila igual no host.
+
+#ifndef TIP_ACCUM_SHARDS
+#define TIP_ACCUM_SHARDS 2  // Um por núcleo do ESP32
+#endif
+
+#ifndef TIP_ACCUM_ALINHAMENTO
+#define TIP_ACCUM_ALINHAMENTO 32  // Evita falso compartilhamento entre os shards
+#endif
+
+typedef struct {
+    _Alignas(TIP_ACCUM_ALINHAMENTO) atomic_uint_fast32_t valor;
+} tip_accum_shard_t;
+
+typedef struct {
+    tip_accum_shard_t shards[TIP_ACCUM_SHARDS];
+} tip_accum_t;
+
+#define TIP_ACCUM_INIT { 0 }
+
+// Soma n basculadas no shard indicado (normalmente o núcleo atual). Seguro em ISR.
+static inline void tip_accum_add(tip_accum_t *acc, unsigned shard, uint32_t n) {
+    atomic_fetch_add_explicit(&acc->shards[shard % TIP_ACCUM_SHARDS].valor, n, memory_order_relaxed);
+}
+
+// Lê e zera todos os shards de forma atômica
+static inline uint32_t tip_accum_take(tip_accum_t *acc) {
+    uint32_t total = 0;
+    for (unsigned i = 0; i < TIP_ACCUM_SHARDS; i++) {
+        total += (uint32_t)atomic_exchange_explicit(&acc->shards[i].valor, 0, memory_order_acq_rel);
+    }
+    return total;
+}
+
+// Lê o total sem zerar (apenas para log/diagnóstico)
+static inline uint32_t tip_accum_peek(tip_accum_t *acc) {
+    uint32_t total = 0;
+    for (unsigned i = 0; i < TIP_ACCUM_SHARDS; i++) {
+        total += (uint32_t)atomic_load_explicit(&acc->shards[i].valor, memory_order_relaxed);
+    }
+    return total;
+}
+
+#endif
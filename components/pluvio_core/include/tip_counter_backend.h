@@ -0,0 +1,17 @@
+#ifndef TIP_COUNTER_BACKEND_H
+#define TIP_COUNTER_BACKEND_H
+
+#include <stdint.h>
+
+// Interface comum das fontes de contagem de basculadas. Não depende do ESP-IDF nem do
+// sdkconfig: os backends do firmware ficam em main/tip_counter_*.c e o contador falso
+// do host em host_test/tip_counter_fake.c.
+typedef struct {
+    const char *nome;
+    int (*init)(int pino);     // Configura o periférico; retorna 0 em caso de sucesso
+    void (*run)(void);         // Laço da sensor_task; NULL quando o hardware conta sozinho
+    uint32_t (*take)(void);    // Lê e zera a contagem de forma atômica
+    void (*despertar_apos)(uint32_t basculadas);  // Acorda do deep sleep após n basculadas; NULL se não conta dormindo
+} tip_counter_backend_t;
+
+#endif
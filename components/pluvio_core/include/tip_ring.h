@@ -0,0 +1,34 @@
+#ifndef TIP_RING_H
+#define TIP_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Buffer circular de eventos de basculada (instante em ms), sem alocação.
+// Um único produtor (sensor_task) e um único consumidor (envio); não usa locks.
+// Só usa C11, então compila igual no host.
+typedef struct {
+    uint32_t *eventos;                   // Armazenamento fornecido por quem inicializa
+    uint32_t mascara;                    // Capacidade - 1 (capacidade é potência de 2)
+    atomic_uint_fast32_t cabeca;         // Próxima posição de escrita (produtor)
+    atomic_uint_fast32_t cauda;          // Próxima posição de leitura (consumidor)
+    atomic_uint_fast32_t pico_ocupacao;  // Maior ocupação já observada
+    atomic_uint_fast32_t descartados;    // Eventos perdidos com o buffer cheio
+} tip_ring_t;
+
+// capacidade precisa ser potência de 2; retorna false caso contrário
+bool tip_ring_init(tip_ring_t *ring, uint32_t *armazenamento, uint32_t capacidade);
+
+// Lado do produtor
+bool tip_ring_push(tip_ring_t *ring, uint32_t timestamp_ms);
+
+// Lado do consumidor: copia até max eventos, do mais antigo ao mais novo
+size_t tip_ring_pop_many(tip_ring_t *ring, uint32_t *destino, size_t max);
+
+uint32_t tip_ring_count(tip_ring_t *ring);
+uint32_t tip_ring_high_water(tip_ring_t *ring);
+uint32_t tip_ring_dropped(tip_ring_t *ring);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef ULP_TIPS_H
+#define ULP_TIPS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Contagem de basculadas pelo ULP: modelo em C do programa ulp/tip_counter.S e as
+// contas que o processador faz sobre os contadores de 16 bits do coprocessador.
+// C puro, para simular no host o que o ULP faz durante o deep sleep
+// (host_test/pluvio_core_test.c).
+
+// Espelho das variáveis do programa ULP
+typedef struct {
+    uint16_t nivel_esperado;
+    uint16_t debounce_contador;
+    uint16_t debounce_max;
+    uint16_t nivel_ativo;
+    uint16_t basculadas;
+    uint16_t limite;
+} ulp_tips_modelo_t;
+
+// Estado inicial do programa com o pino em nivel_atual
+void ulp_tips_modelo_init(ulp_tips_modelo_t *m, int nivel_atual, int nivel_ativo, uint16_t debounce_max);
+
+// Uma execução do programa com o pino em nivel. Retorna true se acordaria o
+// processador (só acontece se processador_dormindo).
+bool ulp_tips_amostrar(ulp_tips_modelo_t *m, int nivel, bool processador_dormindo);
+
+// Basculadas desde a última leitura; atualiza *anterior. Correto na volta dos 16 bits.
+uint32_t ulp_tips_delta(uint16_t atual, uint16_t *anterior);
+
+// Valor de limite que acorda o processador depois de mais n basculadas (1 a 65535)
+uint16_t ulp_tips_limite(uint16_t atual, uint32_t n);
+
+#endif
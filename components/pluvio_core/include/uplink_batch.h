@@ -0,0 +1,26 @@
+#ifndef UPLINK_BATCH_H
+#define UPLINK_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "leitura.h"
+
+// Codificação de várias leituras num único corpo JSON para o bulk_update do ThingSpeak.
+// Escreve direto no buffer fornecido, sem snprintf nem alocação. C puro, roda no host.
+
+// Espaço máximo ocupado por uma leitura no JSON, para dimensionar o buffer
+#define UPLINK_BATCH_BYTES_POR_LEITURA 200
+#define UPLINK_BATCH_BYTES_FIXOS 96
+#define UPLINK_BATCH_BYTES_STATUS 12  // "status" sem o texto
+
+// Monta {"write_api_key":...,"updates":[...]} em buf. epochs[i] é o horário UTC da
+// leitura i (0 = sem horário, o servidor usa o da chegada). status, se não for NULL
+// nem vazio, vai no campo "status" da última leitura; não é escapado, então não pode
+// ter aspas nem barras invertidas. Retorna o tamanho escrito, sem o terminador, ou 0
+// se não couber.
+size_t uplink_batch_encode(char *buf, size_t cap, const char *api_key,
+                           const leitura_t *leituras, const uint32_t *epochs, size_t n,
+                           const char *status);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef UPLINK_BIN_H
+#define UPLINK_BIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "leitura.h"
+
+// Formato binário compacto do envio (uplink_codec_bin). Inteiros em varint (7 bits
+// por byte, o bit alto indica continuação) e, os com sinal, em zigzag:
+//
+//   'P' 'L' versão(1) n
+//   len_chave chave[len_chave]
+//   n vezes:
+//     zigzag(epoch - epoch anterior)   a primeira em relação a 0; epoch 0 = sem horário
+//     basculadas
+//     zigzag(round(campo * 100))       LEITURA_CAMPOS vezes: os %.2f do ThingSpeak
+//   len_status status[len_status]
+//
+// Uma leitura ocupa cerca de 20 bytes, contra 130 a 230 no formulário ou no JSON.
+// tools/uplink_bin_decode.py decodifica no host; um formato novo troca a versão.
+
+#define UPLINK_BIN_VERSAO 1
+#define UPLINK_BIN_CHAVE_MAX 255
+#define UPLINK_BIN_STATUS_MAX 255
+
+// Pior caso: cabeçalho e textos com os tamanhos máximos, todos os varints com 5 bytes
+#define UPLINK_BIN_BYTES_FIXOS (4 + 1 + UPLINK_BIN_CHAVE_MAX + 1 + UPLINK_BIN_STATUS_MAX)
+#define UPLINK_BIN_BYTES_POR_LEITURA (5 + 3 + LEITURA_CAMPOS * 5)
+#define UPLINK_BIN_BYTES(n) (UPLINK_BIN_BYTES_FIXOS + (n) * UPLINK_BIN_BYTES_POR_LEITURA)
+
+// Resultado da decodificação: aponta para dentro do buffer decodificado
+typedef struct {
+    const char *chave;
+    size_t chave_len;
+    const char *status;
+    size_t status_len;
+    size_t n;
+} uplink_bin_cabecalho_t;
+
+// Decodifica até max leituras em leituras (só campos, basculadas e epoch_s
+// são preenchidos). Retorna false se os dados estão truncados ou não são do formato.
+bool uplink_bin_decodificar(const uint8_t *dados, size_t len, uplink_bin_cabecalho_t *cab,
+                            leitura_t *leituras, size_t max);
+
+#endif
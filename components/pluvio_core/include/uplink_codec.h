@@ -0,0 +1,44 @@
+#ifndef UPLINK_CODEC_H
+#define UPLINK_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "leitura.h"
+
+// Interface comum dos formatos do envio. O firmware escolhe um no menuconfig e só
+// monta a requisição com o resultado: uma query acrescentada à URL de envio (GET) ou
+// um corpo de POST com o content_type do codificador. C puro, roda no host.
+
+// O que vai numa requisição
+typedef struct {
+    const char *api_key;
+    const leitura_t *leituras;
+    const uint32_t *epochs;   // Horário UTC de cada leitura; 0 = o servidor usa o da chegada
+    size_t n;
+    const char *status;       // Resumo do diagnóstico, ou NULL; vai com a leitura mais recente
+} uplink_lote_t;
+
+typedef struct {
+    const char *nome;
+    const char *content_type;  // NULL: o resultado é uma query para GET
+    size_t max_leituras;       // Leituras aceitas por requisição
+    // Escreve a requisição em buf; retorna o tamanho, ou 0 se não couber ou se
+    // n passar de max_leituras. Formatos de texto terminam buf com '\0'.
+    size_t (*codificar)(uint8_t *buf, size_t cap, const uplink_lote_t *lote);
+} uplink_codec_t;
+
+// GET /update do ThingSpeak: "&field1=..&field6=..[&created_at=..][&status=..]".
+// A chave vai na URL base. Uma leitura por requisição.
+extern const uplink_codec_t uplink_codec_form;
+
+// POST bulk_update.json do ThingSpeak (uplink_batch.h)
+extern const uplink_codec_t uplink_codec_json;
+
+// POST binário compacto (uplink_bin.h)
+extern const uplink_codec_t uplink_codec_bin;
+
+// Espaço para uma leitura no formulário, sem o status
+#define UPLINK_FORM_BYTES 192
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef WIFI_SM_H
+#define WIFI_SM_H
+
+#include <stdint.h>
+
+// Máquina de estados da conexão STA. Recebe os eventos do WiFi e devolve a ação a
+// tomar; não chama o driver nem lê o relógio, então roda igual no host com uma
+// fonte de eventos simulada. As falhas seguidas aumentam a espera exponencialmente,
+// com jitter e teto; depois de max_falhas a máquina desiste.
+
+typedef enum {
+    WIFI_SM_OCIOSO,
+    WIFI_SM_CONECTANDO,
+    WIFI_SM_CONECTADO,
+    WIFI_SM_ESPERANDO,   // Aguardando o fim do backoff
+    WIFI_SM_DESISTIU,    // max_falhas atingido; quem chama decide entre AP e pausa
+} wifi_sm_estado_t;
+
+typedef enum {
+    WIFI_SM_EV_INICIAR,      // STA iniciada ou retomada após a pausa
+    WIFI_SM_EV_CONECTOU,     // Obteve IP
+    WIFI_SM_EV_DESCONECTOU,  // Falha na tentativa ou perda do link
+    WIFI_SM_EV_TIMER,        // Fim da espera agendada
+} wifi_sm_evento_t;
+
+typedef enum {
+    WIFI_SM_ACAO_NENHUMA,
+    WIFI_SM_ACAO_CONECTAR,   // Chamar esp_wifi_connect
+    WIFI_SM_ACAO_AGENDAR,    // Disparar WIFI_SM_EV_TIMER depois de espera_ms
+    WIFI_SM_ACAO_DESISTIR,
+} wifi_sm_acao_t;
+
+typedef struct {
+    uint32_t base_ms;      // Espera após a primeira falha
+    uint32_t max_ms;       // Teto da espera
+    uint32_t max_falhas;   // Falhas seguidas até desistir (0 = nunca)
+} wifi_sm_config_t;
+
+typedef struct {
+    wifi_sm_config_t cfg;
+    wifi_sm_estado_t estado;
+    uint32_t falhas;       // Falhas seguidas desde o último IP
+    uint32_t espera_ms;    // Válida quando a ação é WIFI_SM_ACAO_AGENDAR
+    uint32_t semente;      // Estado do gerador do jitter
+} wifi_sm_t;
+
+void wifi_sm_init(wifi_sm_t *sm, const wifi_sm_config_t *cfg, uint32_t semente);
+
+// Aplica um evento e retorna a ação correspondente
+wifi_sm_acao_t wifi_sm_evento(wifi_sm_t *sm, wifi_sm_evento_t evento);
+
+const char *wifi_sm_nome_estado(wifi_sm_estado_t estado);
+
+#endif
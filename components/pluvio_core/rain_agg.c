@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "rain_agg.h"
+
+void rain_agg_init(rain_agg_t *agg, uint32_t um_por_basculada) {
+    memset(agg, 0, sizeof(*agg));
+    agg->um_por_basculada = um_por_basculada;
+}
+
+// Cada passo corresponde a tempo decorrido, então o custo é O(1) amortizado;
+// lacunas maiores que o anel zeram a resolução inteira de uma vez.
+void rain_agg_advance(rain_agg_t *agg, uint32_t t_s) {
+    if (!agg->iniciado) {
+        agg->agora_s = t_s;
+        agg->iniciado = true;
+        return;
+    }
+    if (t_s <= agg->agora_s) {
+        return;
+    }
+
+    uint32_t s0 = agg->agora_s;
+    if (t_s - s0 >= RAIN_AGG_SEGUNDOS) {
+        memset(agg->seg, 0, sizeof(agg->seg));
+        agg->soma.total_1min = 0;
+    } else {
+        for (uint32_t s = s0 + 1; s <= t_s; s++) {
+            uint32_t i = s % RAIN_AGG_SEGUNDOS;
+            agg->soma.total_1min -= agg->seg[i];
+            agg->seg[i] = 0;
+        }
+    }
+
+    uint32_t m0 = s0 / 60, m1 = t_s / 60;
+    if (m1 - m0 >= RAIN_AGG_MINUTOS) {
+        memset(agg->min, 0, sizeof(agg->min));
+        agg->soma.total_5min = 0;
+        agg->soma.total_10min = 0;
+        agg->soma.total_1h = 0;
+    } else {
+        for (uint32_t m = m0 + 1; m <= m1; m++) {
+            agg->soma.total_5min -= agg->min[(m + RAIN_AGG_MINUTOS - 5) % RAIN_AGG_MINUTOS];
+            agg->soma.total_10min -= agg->min[(m + RAIN_AGG_MINUTOS - 10) % RAIN_AGG_MINUTOS];
+            agg->soma.total_1h -= agg->min[m % RAIN_AGG_MINUTOS];
+            agg->min[m % RAIN_AGG_MINUTOS] = 0;
+        }
+    }
+
+    uint32_t h0 = s0 / 3600, h1 = t_s / 3600;
+    if (h1 - h0 >= RAIN_AGG_HORAS) {
+        memset(agg->hora, 0, sizeof(agg->hora));
+        agg->soma.total_24h = 0;
+    } else {
+        for (uint32_t h = h0 + 1; h <= h1; h++) {
+            agg->soma.total_24h -= agg->hora[h % RAIN_AGG_HORAS];
+            agg->hora[h % RAIN_AGG_HORAS] = 0;
+        }
+    }
+
+    agg->agora_s = t_s;
+}
+
+#define ATUALIZA_MAXIMO(campo) \
+    if (agg->soma.campo > agg->maximo.campo) agg->maximo.campo = agg->soma.campo
+
+void rain_agg_add(rain_agg_t *agg, uint32_t t_s, uint32_t n) {
+    rain_agg_advance(agg, t_s);
+    t_s = agg->agora_s;
+
+    agg->seg[t_s % RAIN_AGG_SEGUNDOS] += n;
+    agg->min[(t_s / 60) % RAIN_AGG_MINUTOS] += n;
+    agg->hora[(t_s / 3600) % RAIN_AGG_HORAS] += n;
+
+    agg->soma.total_1min += n;
+    agg->soma.total_5min += n;
+    agg->soma.total_10min += n;
+    agg->soma.total_1h += n;
+    agg->soma.total_24h += n;
+
+    ATUALIZA_MAXIMO(total_1min);
+    ATUALIZA_MAXIMO(total_5min);
+    ATUALIZA_MAXIMO(total_10min);
+    ATUALIZA_MAXIMO(total_1h);
+    ATUALIZA_MAXIMO(total_24h);
+}
+
+#undef ATUALIZA_MAXIMO
+
+void rain_agg_reset_max(rain_agg_t *agg) {
+    agg->maximo = agg->soma;
+}
+
+float rain_agg_mm(const rain_agg_t *agg, uint32_t basculadas) {
+    return basculadas * (agg->um_por_basculada / 1000.0f);
+}
+
+float rain_agg_mm_h(const rain_agg_t *agg, uint32_t basculadas, uint32_t janela_s) {
+    if (janela_s == 0) {
+        return 0;
+    }
+    return rain_agg_mm(agg, basculadas) * (3600.0f / janela_s);
+}
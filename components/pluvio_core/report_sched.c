@@ -0,0 +1,69 @@
+#include "report_sched.h"
+
+void report_sched_init(report_sched_t *s, const report_sched_config_t *cfg, uint32_t agora_s) {
+    s->cfg = *cfg;
+    s->nivel = REPORT_SECO;
+    s->ultimo_envio_s = agora_s - cfg->intervalo_seco_s + cfg->intervalo_forte_s;
+    s->chuva_em_s = 0;
+    s->forte_em_s = 0;
+    s->teve_chuva = false;
+    s->teve_forte = false;
+}
+
+report_nivel_t report_sched_atualizar(report_sched_t *s, uint32_t agora_s, uint32_t basculadas_10min) {
+    if (basculadas_10min >= s->cfg.limiar_forte) {
+        s->forte_em_s = agora_s;
+        s->teve_forte = true;
+    }
+    if (basculadas_10min >= s->cfg.limiar_chuva) {
+        s->chuva_em_s = agora_s;
+        s->teve_chuva = true;
+    }
+
+    // Diferenças sem sinal continuam corretas na volta do contador de segundos
+    if (s->teve_forte && agora_s - s->forte_em_s < s->cfg.calmaria_s) {
+        s->nivel = REPORT_FORTE;
+    } else if (s->teve_chuva && agora_s - s->chuva_em_s < s->cfg.calmaria_s) {
+        s->nivel = REPORT_CHUVA;
+    } else {
+        s->nivel = REPORT_SECO;
+    }
+    return s->nivel;
+}
+
+uint32_t report_sched_intervalo_s(const report_sched_t *s) {
+    switch (s->nivel) {
+    case REPORT_FORTE: return s->cfg.intervalo_forte_s;
+    case REPORT_CHUVA: return s->cfg.intervalo_chuva_s;
+    default: return s->cfg.intervalo_seco_s;
+    }
+}
+
+uint32_t report_sched_prazo_s(const report_sched_t *s) {
+    return s->ultimo_envio_s + report_sched_intervalo_s(s);
+}
+
+int32_t report_sched_faltam_s(const report_sched_t *s, uint32_t agora_s) {
+    return (int32_t)(report_sched_prazo_s(s) - agora_s);
+}
+
+uint32_t report_sched_proximo_limiar(const report_sched_t *s) {
+    switch (s->nivel) {
+    case REPORT_SECO: return s->cfg.limiar_chuva;
+    case REPORT_CHUVA: return s->cfg.limiar_forte;
+    default: return 0;
+    }
+}
+
+void report_sched_enviado(report_sched_t *s, uint32_t agora_s) {
+    s->ultimo_envio_s = agora_s;
+}
+
+const char *report_sched_nome(report_nivel_t nivel) {
+    switch (nivel) {
+    case REPORT_SECO: return "seco";
+    case REPORT_CHUVA: return "chuva";
+    case REPORT_FORTE: return "chuva forte";
+    }
+    return "?";
+}
@@ -0,0 +1,62 @@
+#include "tip_ring.h"
+
+bool tip_ring_init(tip_ring_t *ring, uint32_t *armazenamento, uint32_t capacidade) {
+    if (armazenamento == NULL || capacidade == 0 || (capacidade & (capacidade - 1)) != 0) {
+        return false;
+    }
+    ring->eventos = armazenamento;
+    ring->mascara = capacidade - 1;
+    atomic_init(&ring->cabeca, 0);
+    atomic_init(&ring->cauda, 0);
+    atomic_init(&ring->pico_ocupacao, 0);
+    atomic_init(&ring->descartados, 0);
+    return true;
+}
+
+bool tip_ring_push(tip_ring_t *ring, uint32_t timestamp_ms) {
+    uint32_t cabeca = atomic_load_explicit(&ring->cabeca, memory_order_relaxed);
+    uint32_t cauda = atomic_load_explicit(&ring->cauda, memory_order_acquire);
+    uint32_t ocupacao = cabeca - cauda;
+
+    if (ocupacao > ring->mascara) {
+        atomic_fetch_add_explicit(&ring->descartados, 1, memory_order_relaxed);
+        return false;
+    }
+
+    ring->eventos[cabeca & ring->mascara] = timestamp_ms;
+    atomic_store_explicit(&ring->cabeca, cabeca + 1, memory_order_release);
+
+    // Só o produtor escreve o pico, então não há corrida na comparação
+    if (ocupacao + 1 > atomic_load_explicit(&ring->pico_ocupacao, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->pico_ocupacao, ocupacao + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+size_t tip_ring_pop_many(tip_ring_t *ring, uint32_t *destino, size_t max) {
+    uint32_t cauda = atomic_load_explicit(&ring->cauda, memory_order_relaxed);
+    uint32_t cabeca = atomic_load_explicit(&ring->cabeca, memory_order_acquire);
+    size_t n = cabeca - cauda;
+
+    if (n > max) {
+        n = max;
+    }
+    for (size_t i = 0; i < n; i++) {
+        destino[i] = ring->eventos[(cauda + i) & ring->mascara];
+    }
+    atomic_store_explicit(&ring->cauda, cauda + n, memory_order_release);
+    return n;
+}
+
+uint32_t tip_ring_count(tip_ring_t *ring) {
+    return atomic_load_explicit(&ring->cabeca, memory_order_acquire) -
+           atomic_load_explicit(&ring->cauda, memory_order_acquire);
+}
+
+uint32_t tip_ring_high_water(tip_ring_t *ring) {
+    return atomic_load_explicit(&ring->pico_ocupacao, memory_order_relaxed);
+}
+
+uint32_t tip_ring_dropped(tip_ring_t *ring) {
+    return atomic_load_explicit(&ring->descartados, memory_order_relaxed);
+}
@@ -0,0 +1,46 @@
+#include "ulp_tips.h"
+
+void ulp_tips_modelo_init(ulp_tips_modelo_t *m, int nivel_atual, int nivel_ativo, uint16_t debounce_max) {
+    m->nivel_esperado = nivel_atual ? 0 : 1;
+    m->debounce_max = debounce_max;
+    m->debounce_contador = debounce_max;
+    m->nivel_ativo = nivel_ativo ? 1 : 0;
+    m->basculadas = 0;
+    m->limite = 0;
+}
+
+// Mesma sequência de desvios de ulp/tip_counter.S
+bool ulp_tips_amostrar(ulp_tips_modelo_t *m, int nivel, bool processador_dormindo) {
+    if ((nivel & 1) != m->nivel_esperado) {
+        m->debounce_contador = m->debounce_max;
+        return false;
+    }
+    if (m->debounce_contador != 0) {
+        m->debounce_contador--;
+        return false;
+    }
+
+    m->debounce_contador = m->debounce_max;
+    m->nivel_esperado ^= 1;
+    if (m->nivel_esperado != m->nivel_ativo) {
+        return false;  // Borda de fechamento
+    }
+
+    m->basculadas++;
+    return m->basculadas == m->limite && processador_dormindo;
+}
+
+uint32_t ulp_tips_delta(uint16_t atual, uint16_t *anterior) {
+    uint16_t delta = (uint16_t)(atual - *anterior);
+    *anterior = atual;
+    return delta;
+}
+
+uint16_t ulp_tips_limite(uint16_t atual, uint32_t n) {
+    if (n == 0) {
+        n = 1;
+    } else if (n > UINT16_MAX) {
+        n = UINT16_MAX;
+    }
+    return (uint16_t)(atual + n);
+}
@@ -0,0 +1,51 @@
+#include <string.h>
+
+#include "escritor.h"
+#include "uplink_batch.h"
+
+size_t uplink_batch_encode(char *buf, size_t cap, const char *api_key,
+                           const leitura_t *leituras, const uint32_t *epochs, size_t n,
+                           const char *status) {
+    if (cap == 0) {
+        return 0;
+    }
+    escritor_t e = { buf, buf + cap - 1, 0 };  // Reserva o terminador
+
+    ESCREVER_LITERAL(&e, "{\"write_api_key\":\"");
+    escrever(&e, api_key, strlen(api_key));
+    ESCREVER_LITERAL(&e, "\",\"updates\":[");
+
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) {
+            ESCREVER_LITERAL(&e, ",");
+        }
+        ESCREVER_LITERAL(&e, "{");
+        if (epochs[i] != 0) {
+            ESCREVER_LITERAL(&e, "\"created_at\":\"");
+            escrever_data(&e, epochs[i]);
+            ESCREVER_LITERAL(&e, "\",");
+        }
+        for (int campo = 0; campo < LEITURA_CAMPOS; campo++) {
+            if (campo > 0) {
+                ESCREVER_LITERAL(&e, ",");
+            }
+            ESCREVER_LITERAL(&e, "\"field");
+            escrever_uint(&e, (uint32_t)campo + 1, 1);
+            ESCREVER_LITERAL(&e, "\":");
+            escrever_fixo2(&e, leituras[i].campos[campo]);
+        }
+        if (i == n - 1 && status != NULL && status[0] != '\0') {
+            ESCREVER_LITERAL(&e, ",\"status\":\"");
+            escrever(&e, status, strlen(status));
+            ESCREVER_LITERAL(&e, "\"");
+        }
+        ESCREVER_LITERAL(&e, "}");
+    }
+    ESCREVER_LITERAL(&e, "]}");
+
+    if (e.estourou) {
+        return 0;
+    }
+    *e.p = '\0';
+    return (size_t)(e.p - buf);
+}
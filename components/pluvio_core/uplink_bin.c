@@ -0,0 +1,166 @@
+#include <math.h>
+#include <string.h>
+
+#include "uplink_bin.h"
+#include "uplink_codec.h"
+
+typedef struct {
+    uint8_t *p;
+    uint8_t *fim;
+    int estourou;
+} saida_t;
+
+static void escrever_byte(saida_t *s, uint8_t b) {
+    if (s->estourou || s->p == s->fim) {
+        s->estourou = 1;
+        return;
+    }
+    *s->p++ = b;
+}
+
+static void escrever_varint(saida_t *s, uint32_t v) {
+    while (v >= 0x80) {
+        escrever_byte(s, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    escrever_byte(s, (uint8_t)v);
+}
+
+// Números pequenos com qualquer sinal em poucos bytes: 0, -1, 1, -2... -> 0, 1, 2, 3...
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t dezigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void escrever_texto(saida_t *s, const char *texto, size_t max) {
+    size_t len = texto != NULL ? strlen(texto) : 0;
+    if (len > max) {
+        len = max;
+    }
+    escrever_byte(s, (uint8_t)len);
+    if (s->estourou || (size_t)(s->fim - s->p) < len) {
+        s->estourou = 1;
+        return;
+    }
+    memcpy(s->p, texto, len);
+    s->p += len;
+}
+
+// Centésimos, a resolução do "%.2f" dos formatos de texto, saturados no int32
+static int32_t centesimos(float v) {
+    float c = roundf(v * 100.0f);
+    if (c >= 2147483520.0f) {
+        return INT32_MAX;
+    }
+    if (c <= -2147483648.0f) {
+        return INT32_MIN;
+    }
+    return (int32_t)c;
+}
+
+static size_t codificar_bin(uint8_t *buf, size_t cap, const uplink_lote_t *lote) {
+    if (lote->n > UINT8_MAX || strlen(lote->api_key) > UPLINK_BIN_CHAVE_MAX) {
+        return 0;
+    }
+    saida_t s = { buf, buf + cap, 0 };
+
+    escrever_byte(&s, 'P');
+    escrever_byte(&s, 'L');
+    escrever_byte(&s, UPLINK_BIN_VERSAO);
+    escrever_byte(&s, (uint8_t)lote->n);
+    escrever_texto(&s, lote->api_key, UPLINK_BIN_CHAVE_MAX);
+
+    uint32_t anterior = 0;
+    for (size_t i = 0; i < lote->n; i++) {
+        const leitura_t *leitura = &lote->leituras[i];
+        escrever_varint(&s, zigzag((int32_t)(lote->epochs[i] - anterior)));
+        anterior = lote->epochs[i];
+        escrever_varint(&s, leitura->basculadas);
+        for (int campo = 0; campo < LEITURA_CAMPOS; campo++) {
+            escrever_varint(&s, zigzag(centesimos(leitura->campos[campo])));
+        }
+    }
+    // O status é truncado em vez de derrubar o envio
+    escrever_texto(&s, lote->status, UPLINK_BIN_STATUS_MAX);
+
+    return s.estourou ? 0 : (size_t)(s.p - buf);
+}
+
+const uplink_codec_t uplink_codec_bin = {
+    .nome = "binario",
+    .content_type = "application/octet-stream",
+    .max_leituras = UINT8_MAX,
+    .codificar = codificar_bin,
+};
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *fim;
+} entrada_t;
+
+static bool ler_varint(entrada_t *e, uint32_t *v) {
+    *v = 0;
+    for (int deslocamento = 0; deslocamento < 35; deslocamento += 7) {
+        if (e->p == e->fim) {
+            return false;
+        }
+        uint8_t b = *e->p++;
+        *v |= (uint32_t)(b & 0x7f) << deslocamento;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ler_texto(entrada_t *e, const char **texto, size_t *len) {
+    if (e->p == e->fim) {
+        return false;
+    }
+    *len = *e->p++;
+    if ((size_t)(e->fim - e->p) < *len) {
+        return false;
+    }
+    *texto = (const char *)e->p;
+    e->p += *len;
+    return true;
+}
+
+bool uplink_bin_decodificar(const uint8_t *dados, size_t len, uplink_bin_cabecalho_t *cab,
+                            leitura_t *leituras, size_t max) {
+    entrada_t e = { dados, dados + len };
+    if (len < 4 || dados[0] != 'P' || dados[1] != 'L' || dados[2] != UPLINK_BIN_VERSAO) {
+        return false;
+    }
+    cab->n = dados[3];
+    e.p += 4;
+    if (cab->n > max || !ler_texto(&e, &cab->chave, &cab->chave_len)) {
+        return false;
+    }
+
+    uint32_t epoch = 0;
+    for (size_t i = 0; i < cab->n; i++) {
+        leitura_t *leitura = &leituras[i];
+        uint32_t v;
+        memset(leitura, 0, sizeof(*leitura));
+        if (!ler_varint(&e, &v)) {
+            return false;
+        }
+        epoch += (uint32_t)dezigzag(v);
+        leitura->epoch_s = epoch;
+        if (!ler_varint(&e, &v) || v > UINT16_MAX) {
+            return false;
+        }
+        leitura->basculadas = (uint16_t)v;
+        for (int campo = 0; campo < LEITURA_CAMPOS; campo++) {
+            if (!ler_varint(&e, &v)) {
+                return false;
+            }
+            leitura->campos[campo] = (float)dezigzag(v) / 100.0f;
+        }
+    }
+    return ler_texto(&e, &cab->status, &cab->status_len) && e.p == e.fim;
+}
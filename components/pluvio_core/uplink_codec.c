@@ -0,0 +1,54 @@
+#include <string.h>
+
+#include "escritor.h"
+#include "uplink_batch.h"
+#include "uplink_codec.h"
+
+// Mesma saída do snprintf("&field1=%.2f...") e do strftime do envio individual
+static size_t codificar_form(uint8_t *buf, size_t cap, const uplink_lote_t *lote) {
+    if (cap == 0 || lote->n != 1) {
+        return 0;
+    }
+    const leitura_t *leitura = &lote->leituras[0];
+    escritor_t e = { (char *)buf, (char *)buf + cap - 1, 0 };  // Reserva o terminador
+
+    for (int campo = 0; campo < LEITURA_CAMPOS; campo++) {
+        ESCREVER_LITERAL(&e, "&field");
+        escrever_uint(&e, (uint32_t)campo + 1, 1);
+        ESCREVER_LITERAL(&e, "=");
+        escrever_fixo2(&e, leitura->campos[campo]);
+    }
+    if (lote->epochs[0] != 0) {
+        ESCREVER_LITERAL(&e, "&created_at=");
+        escrever_data(&e, lote->epochs[0]);
+    }
+    if (lote->status != NULL && lote->status[0] != '\0') {
+        ESCREVER_LITERAL(&e, "&status=");
+        escrever(&e, lote->status, strlen(lote->status));
+    }
+
+    if (e.estourou) {
+        return 0;
+    }
+    *e.p = '\0';
+    return (size_t)(e.p - (char *)buf);
+}
+
+static size_t codificar_json(uint8_t *buf, size_t cap, const uplink_lote_t *lote) {
+    return uplink_batch_encode((char *)buf, cap, lote->api_key, lote->leituras, lote->epochs, lote->n,
+                               lote->status);
+}
+
+const uplink_codec_t uplink_codec_form = {
+    .nome = "form",
+    .content_type = NULL,
+    .max_leituras = 1,
+    .codificar = codificar_form,
+};
+
+const uplink_codec_t uplink_codec_json = {
+    .nome = "json",
+    .content_type = "application/json",
+    .max_leituras = SIZE_MAX,
+    .codificar = codificar_json,
+};
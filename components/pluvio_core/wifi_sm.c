@@ -0,0 +1,86 @@
+#include "wifi_sm.h"
+
+void wifi_sm_init(wifi_sm_t *sm, const wifi_sm_config_t *cfg, uint32_t semente) {
+    sm->cfg = *cfg;
+    sm->estado = WIFI_SM_OCIOSO;
+    sm->falhas = 0;
+    sm->espera_ms = 0;
+    sm->semente = semente != 0 ? semente : 1;  // xorshift não sai do zero
+}
+
+static uint32_t aleatorio(wifi_sm_t *sm) {
+    uint32_t x = sm->semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sm->semente = x;
+    return x;
+}
+
+// base * 2^(falhas-1), limitada ao teto, sorteada entre metade e o valor cheio
+// para que uma frota que perdeu o mesmo AP não volte toda no mesmo instante
+static uint32_t calcular_espera(wifi_sm_t *sm) {
+    uint32_t espera = sm->cfg.base_ms;
+    for (uint32_t i = 1; i < sm->falhas && espera < sm->cfg.max_ms; i++) {
+        espera *= 2;
+    }
+    if (espera > sm->cfg.max_ms) {
+        espera = sm->cfg.max_ms;
+    }
+    uint32_t metade = espera / 2;
+    return metade + aleatorio(sm) % (espera - metade + 1);
+}
+
+wifi_sm_acao_t wifi_sm_evento(wifi_sm_t *sm, wifi_sm_evento_t evento) {
+    switch (evento) {
+    case WIFI_SM_EV_INICIAR:
+        if (sm->estado == WIFI_SM_OCIOSO || sm->estado == WIFI_SM_DESISTIU) {
+            sm->falhas = 0;
+            sm->estado = WIFI_SM_CONECTANDO;
+            return WIFI_SM_ACAO_CONECTAR;
+        }
+        return WIFI_SM_ACAO_NENHUMA;  // Já tentando ou esperando
+
+    case WIFI_SM_EV_CONECTOU:
+        sm->falhas = 0;
+        sm->estado = WIFI_SM_CONECTADO;
+        return WIFI_SM_ACAO_NENHUMA;
+
+    case WIFI_SM_EV_DESCONECTOU:
+        if (sm->estado == WIFI_SM_CONECTADO) {
+            // Perda do link: a primeira tentativa é imediata
+            sm->estado = WIFI_SM_CONECTANDO;
+            return WIFI_SM_ACAO_CONECTAR;
+        }
+        if (sm->estado != WIFI_SM_CONECTANDO) {
+            return WIFI_SM_ACAO_NENHUMA;  // Evento atrasado de uma tentativa anterior
+        }
+        sm->falhas++;
+        if (sm->cfg.max_falhas != 0 && sm->falhas >= sm->cfg.max_falhas) {
+            sm->estado = WIFI_SM_DESISTIU;
+            return WIFI_SM_ACAO_DESISTIR;
+        }
+        sm->espera_ms = calcular_espera(sm);
+        sm->estado = WIFI_SM_ESPERANDO;
+        return WIFI_SM_ACAO_AGENDAR;
+
+    case WIFI_SM_EV_TIMER:
+        if (sm->estado == WIFI_SM_ESPERANDO) {
+            sm->estado = WIFI_SM_CONECTANDO;
+            return WIFI_SM_ACAO_CONECTAR;
+        }
+        return WIFI_SM_ACAO_NENHUMA;
+    }
+    return WIFI_SM_ACAO_NENHUMA;
+}
+
+const char *wifi_sm_nome_estado(wifi_sm_estado_t estado) {
+    switch (estado) {
+    case WIFI_SM_OCIOSO: return "ocioso";
+    case WIFI_SM_CONECTANDO: return "conectando";
+    case WIFI_SM_CONECTADO: return "conectado";
+    case WIFI_SM_ESPERANDO: return "esperando";
+    case WIFI_SM_DESISTIU: return "desistiu";
+    }
+    return "?";
+}
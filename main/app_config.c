@@ -0,0 +1,121 @@
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+
+#include "app_config.h"
+
+#define APP_CONFIG_NAMESPACE "pluvio"
+
+static const char* TAG = "APP_CONFIG";
+
+static app_config_t config = {
+    .thingspeak_api_key = CONFIG_PLUVIO_THINGSPEAK_API_KEY,
+    .thingspeak_url = CONFIG_PLUVIO_THINGSPEAK_URL,
+    .thingspeak_canal = CONFIG_PLUVIO_THINGSPEAK_CHANNEL_ID,
+    .pino_sensor = CONFIG_PLUVIO_GPIO_SENSOR,
+    .pino_led = CONFIG_PLUVIO_GPIO_LED,
+    .pino_botao = CONFIG_PLUVIO_GPIO_BOTAO,
+    .um_por_basculada = CONFIG_PLUVIO_UM_POR_BASCULADA,
+    .envio_seco_s = CONFIG_PLUVIO_ENVIO_SECO_S,
+    .envio_chuva_s = CONFIG_PLUVIO_ENVIO_CHUVA_S,
+    .envio_forte_s = CONFIG_PLUVIO_ENVIO_FORTE_S,
+    .limiar_chuva_10min = CONFIG_PLUVIO_LIMIAR_CHUVA_10MIN,
+    .limiar_forte_10min = CONFIG_PLUVIO_LIMIAR_FORTE_10MIN,
+    .calmaria_min = CONFIG_PLUVIO_CALMARIA_MIN,
+    .offline_replay_ms = CONFIG_PLUVIO_OFFLINE_REPLAY_MS,
+    .nucleo_sensor = CONFIG_PLUVIO_NUCLEO_SENSOR,
+    .nucleo_envio = CONFIG_PLUVIO_NUCLEO_ENVIO,
+    .nucleo_botao = CONFIG_PLUVIO_NUCLEO_BOTAO,
+};
+
+// Chaves numéricas aceitas na NVS, com as mesmas faixas do menuconfig
+static const struct {
+    const char *chave;
+    size_t offset;
+    uint32_t min;
+    uint32_t max;
+} campos_u32[] = {
+    { "gpio_sensor", offsetof(app_config_t, pino_sensor), 0, 39 },
+    { "gpio_led", offsetof(app_config_t, pino_led), 0, 33 },
+    { "gpio_botao", offsetof(app_config_t, pino_botao), 0, 39 },
+    { "um_basculada", offsetof(app_config_t, um_por_basculada), 1, 100000 },
+    { "envio_seco_s", offsetof(app_config_t, envio_seco_s), 60, 86400 },
+    { "envio_chuva_s", offsetof(app_config_t, envio_chuva_s), 15, 86400 },
+    { "envio_forte_s", offsetof(app_config_t, envio_forte_s), 15, 86400 },
+    { "limiar_chuva", offsetof(app_config_t, limiar_chuva_10min), 1, 10000 },
+    { "limiar_forte", offsetof(app_config_t, limiar_forte_10min), 1, 10000 },
+    { "calmaria_min", offsetof(app_config_t, calmaria_min), 0, 1440 },
+    { "replay_ms", offsetof(app_config_t, offline_replay_ms), 1000, 600000 },
+    { "nucleo_sensor", offsetof(app_config_t, nucleo_sensor), 0, 1 },
+    { "nucleo_envio", offsetof(app_config_t, nucleo_envio), 0, 1 },
+    { "nucleo_botao", offsetof(app_config_t, nucleo_botao), 0, 1 },
+};
+
+static const struct {
+    const char *chave;
+    size_t offset;
+    size_t tamanho;
+} campos_str[] = {
+    { "ts_api_key", offsetof(app_config_t, thingspeak_api_key), APP_CONFIG_API_KEY_MAX },
+    { "ts_url", offsetof(app_config_t, thingspeak_url), APP_CONFIG_URL_MAX },
+    { "ts_canal", offsetof(app_config_t, thingspeak_canal), APP_CONFIG_CANAL_MAX },
+};
+
+#define NUM_CAMPOS_U32 (sizeof(campos_u32) / sizeof(campos_u32[0]))
+#define NUM_CAMPOS_STR (sizeof(campos_str) / sizeof(campos_str[0]))
+
+esp_err_t app_config_init(void) {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(APP_CONFIG_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "Sem ajustes na NVS; usando os valores do menuconfig");
+        return ESP_OK;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao abrir a NVS: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    int ajustes = 0;
+    for (size_t i = 0; i < NUM_CAMPOS_U32; i++) {
+        uint32_t valor;
+        if (nvs_get_u32(nvs_handle, campos_u32[i].chave, &valor) != ESP_OK) {
+            continue;
+        }
+        if (valor < campos_u32[i].min || valor > campos_u32[i].max) {
+            ESP_LOGW(TAG, "%s=%lu fora da faixa %lu..%lu; ignorado", campos_u32[i].chave,
+                     (unsigned long)valor, (unsigned long)campos_u32[i].min, (unsigned long)campos_u32[i].max);
+            continue;
+        }
+        *(uint32_t *)((char *)&config + campos_u32[i].offset) = valor;
+        ESP_LOGI(TAG, "%s=%lu (NVS)", campos_u32[i].chave, (unsigned long)valor);
+        ajustes++;
+    }
+
+    for (size_t i = 0; i < NUM_CAMPOS_STR; i++) {
+        char valor[APP_CONFIG_URL_MAX];
+        size_t len = campos_str[i].tamanho;
+        err = nvs_get_str(nvs_handle, campos_str[i].chave, valor, &len);
+        if (err == ESP_ERR_NVS_INVALID_LENGTH) {
+            ESP_LOGW(TAG, "%s com mais de %u caracteres; ignorado",
+                     campos_str[i].chave, (unsigned)campos_str[i].tamanho - 1);
+            continue;
+        }
+        if (err != ESP_OK) {
+            continue;
+        }
+        memcpy((char *)&config + campos_str[i].offset, valor, len);
+        ESP_LOGI(TAG, "%s definido pela NVS", campos_str[i].chave);  // Sem o valor: pode ser a chave da API
+        ajustes++;
+    }
+
+    nvs_close(nvs_handle);
+    ESP_LOGI(TAG, "%d ajustes lidos da NVS", ajustes);
+    return ESP_OK;
+}
+
+const app_config_t *app_config(void) {
+    return &config;
+}
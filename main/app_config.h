@@ -0,0 +1,57 @@
+#ifndef APP_CONFIG_H
+#define APP_CONFIG_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Configuração do dispositivo: valores padrão do menuconfig, sobrescritos pelas
+// chaves do namespace "pluvio" da NVS. Lida uma vez no boot e mantida em RAM, de
+// modo que a mesma imagem atende estações com chave, pinos ou calibração
+// diferentes sem consultar a NVS durante o funcionamento.
+
+#define APP_CONFIG_API_KEY_MAX 24
+#define APP_CONFIG_URL_MAX 96
+#define APP_CONFIG_CANAL_MAX 16
+
+typedef struct {
+    char thingspeak_api_key[APP_CONFIG_API_KEY_MAX];  // NVS "ts_api_key"
+    char thingspeak_url[APP_CONFIG_URL_MAX];          // "ts_url", termina em "api_key="
+    char thingspeak_canal[APP_CONFIG_CANAL_MAX];      // "ts_canal", usado no envio em lote
+
+    uint32_t pino_sensor;         // "gpio_sensor"
+    uint32_t pino_led;            // "gpio_led"
+    uint32_t pino_botao;          // "gpio_botao"
+
+    uint32_t um_por_basculada;    // "um_basculada"
+
+    uint32_t envio_seco_s;        // "envio_seco_s"
+    uint32_t envio_chuva_s;       // "envio_chuva_s"
+    uint32_t envio_forte_s;       // "envio_forte_s"
+    uint32_t limiar_chuva_10min;  // "limiar_chuva"
+    uint32_t limiar_forte_10min;  // "limiar_forte"
+    uint32_t calmaria_min;        // "calmaria_min"
+    uint32_t offline_replay_ms;   // "replay_ms"
+
+    // As pilhas das tasks são estáticas e ficam só no menuconfig (CONFIG_PLUVIO_PILHA_*)
+    uint32_t nucleo_sensor;       // "nucleo_sensor"
+    uint32_t nucleo_envio;        // "nucleo_envio"
+    uint32_t nucleo_botao;        // "nucleo_botao"
+} app_config_t;
+
+// Carrega a configuração. Chamar depois do nvs_flash_init e antes de criar as
+// tasks; sem NVS fica com os valores do menuconfig. Valores fora da faixa são
+// ignorados com um aviso.
+esp_err_t app_config_init(void);
+
+// Configuração carregada; válida em qualquer task depois do app_config_init
+const app_config_t *app_config(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+#include <sys/time.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "deep_sleep.h"
+
+#define ESPERA_MINIMA_US 1000000LL
+
+static const char* TAG = "DEEP_SLEEP";
+
+static RTC_DATA_ATTR int64_t relogio_base_us = 0;    // Somado ao esp_timer
+static RTC_DATA_ATTR int64_t adormeceu_em_us = 0;    // gettimeofday ao entrar no sono
+static bool acordou = false;
+
+// O RTC continua contando no sono, então a hora do sistema atravessa o deep sleep
+static int64_t hora_do_sistema_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+void deep_sleep_init(void) {
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        relogio_base_us = 0;
+        return;
+    }
+    acordou = true;
+
+    // O tempo desde o início do sono inclui o boot, que o esp_timer também já contou
+    int64_t dormiu_us = hora_do_sistema_us() - adormeceu_em_us;
+    relogio_base_us += dormiu_us - esp_timer_get_time();
+
+    esp_sleep_wakeup_cause_t causa = esp_sleep_get_wakeup_cause();
+    ESP_LOGI(TAG, "Acordou após %lld ms de sono (%s)", dormiu_us / 1000,
+             causa == ESP_SLEEP_WAKEUP_ULP ? "limite de basculadas" : "prazo do envio");
+}
+
+bool deep_sleep_acordou(void) {
+    return acordou;
+}
+
+int64_t deep_sleep_relogio_us(void) {
+    return relogio_base_us + esp_timer_get_time();
+}
+
+void deep_sleep_dormir(int64_t prazo_us, bool acordar_pelo_ulp) {
+    int64_t espera_us = prazo_us - deep_sleep_relogio_us();
+    if (espera_us < ESPERA_MINIMA_US) {
+        espera_us = ESPERA_MINIMA_US;
+    }
+
+    esp_sleep_enable_timer_wakeup(espera_us);
+    if (acordar_pelo_ulp) {
+        esp_sleep_enable_ulp_wakeup();
+    }
+    // O ULP lê o pino do sensor pelos periféricos RTC
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+
+    ESP_LOGI(TAG, "Dormindo por até %lld ms", espera_us / 1000);
+    relogio_base_us += esp_timer_get_time();
+    adormeceu_em_us = hora_do_sistema_us();
+    esp_deep_sleep_start();
+}
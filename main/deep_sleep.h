@@ -0,0 +1,23 @@
+#ifndef DEEP_SLEEP_H
+#define DEEP_SLEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Modo de baixo consumo: o dispositivo acorda, mede, envia e volta ao deep sleep.
+// O esp_timer recomeça do zero a cada despertar; este módulo mantém na memória RTC
+// um relógio monotônico que continua contando durante o sono.
+
+// Chamar no início do app_main; soma ao relógio o tempo dormido
+void deep_sleep_init(void);
+
+// true se este boot veio de um deep sleep
+bool deep_sleep_acordou(void);
+
+// Microssegundos desde o primeiro boot, incluindo o tempo dormido
+int64_t deep_sleep_relogio_us(void);
+
+// Dorme até prazo_us (no relógio acima) ou até o ULP acordar o processador
+void deep_sleep_dormir(int64_t prazo_us, bool acordar_pelo_ulp);
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "diag.h"
+#include "heap_track.h"
+
+static char ultimo[DIAG_STATUS_MAX] = "";
+static portMUX_TYPE ultimo_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_PLUVIO_DIAG
+static const char* TAG = "DIAG";
+
+#define DIAG_MAX_TASKS 24
+#define FOLGA_MINIMA_PILHA CONFIG_PLUVIO_DIAG_FOLGA_MINIMA
+
+// Tasks da aplicação que entram no resumo. Os nomes são comparados só até o limite
+// do FreeRTOS (CONFIG_FREERTOS_MAX_TASK_NAME_LEN), que corta os mais longos.
+static const struct {
+    const char *nome;
+    const char *sigla;
+} tasks_app[] = {
+    { "sensor_task", "sen" },
+    { "send_data_thingspeak", "env" },
+    { "check_reset_button", "bot" },
+    { "dns_server", "dns" },
+    { "blink_led_task", "led" },
+};
+#define NUM_TASKS_APP (sizeof(tasks_app) / sizeof(tasks_app[0]))
+
+static TaskStatus_t estado[DIAG_MAX_TASKS];
+
+// Tempo de execução de cada task na amostra anterior, para calcular a diferença
+static struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE tempo;
+} anterior[DIAG_MAX_TASKS];
+static size_t n_anterior = 0;
+static configRUN_TIME_COUNTER_TYPE total_anterior = 0;
+
+static configRUN_TIME_COUNTER_TYPE tempo_anterior(TaskHandle_t handle) {
+    for (size_t i = 0; i < n_anterior; i++) {
+        if (anterior[i].handle == handle) {
+            return anterior[i].tempo;
+        }
+    }
+    return 0;  // Task criada depois da amostra anterior
+}
+
+static int sigla_da_task(const char *nome) {
+    for (size_t i = 0; i < NUM_TASKS_APP; i++) {
+        if (strncmp(nome, tasks_app[i].nome, configMAX_TASK_NAME_LEN - 1) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// Parte de um núcleo usada no intervalo, em %
+static uint32_t porcentagem(configRUN_TIME_COUNTER_TYPE parte, configRUN_TIME_COUNTER_TYPE total) {
+    return total > 0 ? (uint32_t)((uint64_t)parte * 100 / total) : 0;
+}
+#endif
+
+size_t diag_amostrar(char *status, size_t cap) {
+#if CONFIG_PLUVIO_DIAG
+    if (cap == 0) {
+        return 0;
+    }
+    int64_t inicio_us = esp_timer_get_time();
+
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t n = uxTaskGetSystemState(estado, DIAG_MAX_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "Mais de %d tasks; amostra descartada", DIAG_MAX_TASKS);
+        status[0] = '\0';
+        return 0;
+    }
+    // Contadores do esp_timer, em us. O sdkconfig usa 64 bits: com 32 eles dão a
+    // volta em 71 min, menos que o intervalo de envio sem chuva pode chegar
+    configRUN_TIME_COUNTER_TYPE intervalo = total - total_anterior;
+
+    // Carga de cada núcleo: o que sobra do tempo da task idle dele
+    uint32_t carga[portNUM_PROCESSORS];
+    for (int nucleo = 0; nucleo < portNUM_PROCESSORS; nucleo++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(nucleo);
+        carga[nucleo] = 100;
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (estado[i].xHandle == idle) {
+                uint32_t ocioso = porcentagem(estado[i].ulRunTimeCounter - tempo_anterior(idle), intervalo);
+                carga[nucleo] = ocioso < 100 ? 100 - ocioso : 0;
+            }
+        }
+    }
+
+    int len = snprintf(status, cap, "cpu:%lu", (unsigned long)carga[0]);
+    for (int nucleo = 1; nucleo < portNUM_PROCESSORS && len > 0 && (size_t)len < cap; nucleo++) {
+        len += snprintf(status + len, cap - len, "/%lu", (unsigned long)carga[nucleo]);
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *t = &estado[i];
+        uint32_t uso = porcentagem(t->ulRunTimeCounter - tempo_anterior(t->xHandle), intervalo);
+        uint32_t folga = (uint32_t)t->usStackHighWaterMark;  // Em bytes: StackType_t é uint8_t no ESP-IDF
+
+        ESP_LOGD(TAG, "%-16s %3lu%% folga %5lu B", t->pcTaskName, (unsigned long)uso, (unsigned long)folga);
+        int app = sigla_da_task(t->pcTaskName);
+        if (app < 0) {
+            continue;
+        }
+        if (folga < FOLGA_MINIMA_PILHA) {
+            ESP_LOGW(TAG, "Pilha de %s quase cheia: restam %lu bytes", t->pcTaskName, (unsigned long)folga);
+        }
+        if (len > 0 && (size_t)len < cap) {
+            len += snprintf(status + len, cap - len, ",%s:%lu/%lu",
+                            tasks_app[app].sigla, (unsigned long)uso, (unsigned long)folga);
+        }
+    }
+
+    heap_track_amostra_t heap;
+    heap_track_amostrar(&heap);
+    heap_track_relatorio(&heap);
+    if (len > 0 && (size_t)len < cap) {
+        len += snprintf(status + len, cap - len, ",heap:%lu/%lu",
+                        (unsigned long)heap.livre_minimo, (unsigned long)heap.maior_bloco);
+    }
+    if (len < 0 || (size_t)len >= cap) {
+        len = (int)strlen(status);  // Resumo cortado, mas terminado
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        anterior[i].handle = estado[i].xHandle;
+        anterior[i].tempo = estado[i].ulRunTimeCounter;
+    }
+    n_anterior = n;
+    total_anterior = total;
+
+    taskENTER_CRITICAL(&ultimo_lock);
+    strlcpy(ultimo, status, sizeof(ultimo));
+    taskEXIT_CRITICAL(&ultimo_lock);
+
+    ESP_LOGI(TAG, "%s (%u tasks, %lu s, amostra em %lld us)", status, (unsigned)n,
+             (unsigned long)(intervalo / 1000000), esp_timer_get_time() - inicio_us);
+    return (size_t)len;
+#else
+    if (cap > 0) {
+        status[0] = '\0';
+    }
+    return 0;
+#endif
+}
+
+void diag_ultimo(char *status, size_t cap) {
+    taskENTER_CRITICAL(&ultimo_lock);
+    strlcpy(status, ultimo, cap);
+    taskEXIT_CRITICAL(&ultimo_lock);
+}
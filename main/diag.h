@@ -0,0 +1,24 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <stddef.h>
+
+// Diagnóstico das tasks: carga de cada núcleo e de cada task da aplicação, pelos
+// contadores de tempo de execução do FreeRTOS, e a menor folga de pilha já vista.
+// Amostrado a cada envio; o resumo vai no campo "status" do ThingSpeak.
+
+// Tamanho máximo do resumo, com o terminador
+#define DIAG_STATUS_MAX 128
+
+// Amostra a carga desde a amostra anterior (ou desde o boot) e a folga das pilhas.
+// Escreve o resumo em status, por exemplo "cpu:12/3,sen:0/412,env:2/1840,heap:41200/28672",
+// com a carga de cada núcleo; por task, a % de um núcleo e a folga de pilha em bytes;
+// e o menor heap livre desde o boot e o maior bloco livre agora.
+// Registra o detalhe no log e avisa das pilhas quase cheias. Retorna o tamanho do
+// resumo; 0 sem CONFIG_PLUVIO_DIAG.
+size_t diag_amostrar(char *status, size_t cap);
+
+// Último resumo amostrado ("" se ainda não houve amostra)
+void diag_ultimo(char *status, size_t cap);
+
+#endif
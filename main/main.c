@@ -7,39 +7,43 @@
 #include "nvs_flash.h"
 
 // libs dev
+#include "app_config.h"
+#include "deep_sleep.h"
+#include "heap_track.h"
+#include "power.h"
+#include "qemu_teste.h"
 #include "wifi_manager.h"
 #include "sensor_task.h"
+#include "tasks.h"
 
-#define BOOT_BUTTON_PIN GPIO_NUM_0  // O botão BOOT está ligado ao GPIO 0
 #define BUTTON_PRESS_TIME 5  // Tempo para resetar em segundos
-#define LED_PIN GPIO_NUM_2  // GPIO do LED na ESP32 WROOM-32
 #define DNS_PORT 53
 #define CAPTIVE_PORTAL_IP "192.168.4.1"
 
 // Função para configurar o LED como saída
 void configure_led() {
-    gpio_reset_pin(LED_PIN);
-    gpio_set_direction(LED_PIN, GPIO_MODE_OUTPUT);
+    gpio_reset_pin(app_config()->pino_led);
+    gpio_set_direction(app_config()->pino_led, GPIO_MODE_OUTPUT);
 }
 
 // Função para piscar o LED (modo AP)
 void blink_led_task(void *pvParameter) {
     while (true) {
-        gpio_set_level(LED_PIN, 1);  // Liga o LED
+        gpio_set_level(app_config()->pino_led, 1);  // Liga o LED
         vTaskDelay(500 / portTICK_PERIOD_MS);  // Aguardar 500ms
-        gpio_set_level(LED_PIN, 0);  // Desliga o LED
+        gpio_set_level(app_config()->pino_led, 0);  // Desliga o LED
         vTaskDelay(500 / portTICK_PERIOD_MS);  // Aguardar 500ms
     }
 }
 
 // Função para manter o LED aceso (modo STA)
 void led_on() {
-    gpio_set_level(LED_PIN, 1);  // Liga o LED permanentemente
+    gpio_set_level(app_config()->pino_led, 1);  // Liga o LED permanentemente
 }
 
 // Função para apagar o LED (caso precise resetar)
 void led_off() {
-    gpio_set_level(LED_PIN, 0);  // Desliga o LED
+    gpio_set_level(app_config()->pino_led, 0);  // Desliga o LED
 }
 
 
@@ -60,11 +64,11 @@ void get_saved_wifi_credentials(char *ssid, char *password) {
 }
 
 
-void check_reset_button() {
+void check_reset_button(void *pvParameter) {
     int64_t press_start_time = 0;  // Variável para armazenar o tempo inicial da pressão
 
     while (true) {
-        if (gpio_get_level(BOOT_BUTTON_PIN) == 0) {  // Botão pressionado
+        if (gpio_get_level(app_config()->pino_botao) == 0) {  // Botão pressionado
             if (press_start_time == 0) {
                 press_start_time = esp_timer_get_time();  // Registra o tempo de início
             } else if ((esp_timer_get_time() - press_start_time) >= BUTTON_PRESS_TIME * 1000) {
@@ -102,6 +106,10 @@ void app_main() {
    // esp_task_wdt_deinit();
     //esp_task_wdt_init(10, false);  // Inicializa o WDT com um timeout de 10 segundos
 
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+    deep_sleep_init();  // Antes de qualquer leitura do relógio
+#endif
+
     // Inicializa NVS
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -110,15 +118,28 @@ void app_main() {
     }
     ESP_ERROR_CHECK(ret);
 
+    // Valores do menuconfig com os ajustes desta estação gravados na NVS
+    app_config_init();
+    const app_config_t *config = app_config();
+
+    // DFS e light sleep automático; as tasks dormem com vTaskDelay e o idle sem tick
+    power_init();
+
     // Configura o GPIO do botão e do LED
     configure_led();  // Configura o LED
 
-    // Configura o botão BOOT (GPIO 0)
-    gpio_reset_pin(BOOT_BUTTON_PIN);
-    gpio_set_direction(BOOT_BUTTON_PIN, GPIO_MODE_INPUT);
-    gpio_pullup_en(BOOT_BUTTON_PIN);  // debounce
-
-    // Configura WiFi
+    // Configura o botão de reset (BOOT, GPIO 0 na placa padrão)
+    gpio_reset_pin(config->pino_botao);
+    gpio_set_direction(config->pino_botao, GPIO_MODE_INPUT);
+    gpio_pullup_en(config->pino_botao);  // debounce
+
+#if CONFIG_PLUVIO_QEMU
+    // Teste no QEMU: Ethernet emulada no lugar do WiFi e basculadas injetadas pelo console
+    qemu_teste_iniciar();
+#else
+    // Configura WiFi. O que for alocado daqui até o fim da configuração, e depois
+    // pelas tasks do driver, da pilha TCP/IP e de eventos, conta como WiFi.
+    heap_sub_t marca = heap_track_entrar(HEAP_SUB_WIFI);
     bool credentials_exist = wifi_credentials_exist();
     char ssid[32] = {0};
     char password[64] = {0};
@@ -126,13 +147,12 @@ void app_main() {
         get_saved_wifi_credentials(ssid, password);  // Função que retorna o SSID e senha salvos
     }
     start_wifi_configuration(credentials_exist, ssid, password); 
-
-    // Inicia a rotina do sensor no núcleo 0 (PRO CPU)
-    xTaskCreatePinnedToCore(sensor_task, "sensor_task", 2048, NULL, 5, NULL, 0);  // Núcleo 0
-
-    // Envia dados para o thingspeak no núcleo 1 (APP CPU)
-    xTaskCreatePinnedToCore(send_data_thingspeak, "send_data_thingspeak", 4096, NULL, 5, NULL, 1);  // Núcleo 1
-
-    // Verifica o botão de reset no núcleo 1 (APP CPU)
-    xTaskCreatePinnedToCore(check_reset_button, "check_reset_button", 2048, NULL, 5, NULL, 1);  // Núcleo 1
+    heap_track_sair(marca);
+    heap_track_marcar_task("wifi", HEAP_SUB_WIFI);
+    heap_track_marcar_task("tiT", HEAP_SUB_WIFI);
+    heap_track_marcar_task("sys_evt", HEAP_SUB_WIFI);
+#endif
+
+    // Sensor, envio ao ThingSpeak e botão de reset, com pilhas estáticas
+    tasks_iniciar();
 }
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include <stdbool.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+
+#include "offline_log.h"
+
+// Layout na flash (little endian), documentado também em tools/pluvlog_dump.py:
+//   setor:   [magic][seq do setor][tamanho do slot][reservado] e depois os slots
+//   slot:    [crc32][seq][registro + padding][commit][enviado]
+// O CRC cobre seq e registro. "enviado" fica em 0xFFFFFFFF até o registro ser
+// enviado e então é zerado, sem precisar apagar o setor.
+#define SETOR_TAM 4096
+#define CAB_SETOR_TAM 16
+#define LOG_MAGIC 0x474F4C50u   // "PLOG"
+#define LOG_COMMIT 0x54494D43u  // "CMIT"
+#define PALAVRA_APAGADA 0xFFFFFFFFu
+#define OFF_CRC 0
+#define OFF_SEQ 4
+#define OFF_DADOS 8
+
+static const char* TAG = "OFFLINE_LOG";
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t tam_slot;
+    uint32_t reservado;
+} cab_setor_t;
+
+typedef enum {
+    SLOT_LIVRE,
+    SLOT_PENDENTE,
+    SLOT_ENVIADO,
+    SLOT_INVALIDO,
+} estado_slot_t;
+
+typedef struct {
+    uint32_t setor;
+    uint32_t slot;
+} posicao_t;
+
+static const esp_partition_t *particao = NULL;
+static uint32_t n_setores, slots_por_setor, tam_slot, tam_registro, tam_dados;
+static posicao_t cabeca;   // Próximo slot livre
+static posicao_t cauda;    // Registro pendente mais antigo (ou a cabeça, se não houver)
+static uint32_t seq_setor_cabeca, proximo_seq;
+static uint32_t pendentes, perdidos;
+static uint8_t slot_buf[16 + OFFLINE_LOG_REGISTRO_MAX];
+
+static size_t endereco(posicao_t p) {
+    return (size_t)p.setor * SETOR_TAM + CAB_SETOR_TAM + (size_t)p.slot * tam_slot;
+}
+
+static void avancar(posicao_t *p) {
+    if (++p->slot >= slots_por_setor) {
+        p->slot = 0;
+        p->setor = (p->setor + 1) % n_setores;
+    }
+}
+
+static bool mesma_posicao(posicao_t a, posicao_t b) {
+    return a.setor == b.setor && a.slot == b.slot;
+}
+
+static uint32_t ler_palavra(size_t offset) {
+    uint32_t valor;
+    memcpy(&valor, slot_buf + offset, sizeof(valor));
+    return valor;
+}
+
+static bool setor_valido(uint32_t setor, cab_setor_t *cab) {
+    if (esp_partition_read(particao, (size_t)setor * SETOR_TAM, cab, sizeof(*cab)) != ESP_OK) {
+        return false;
+    }
+    return cab->magic == LOG_MAGIC && cab->tam_slot == tam_slot;
+}
+
+// Lê o slot para slot_buf e classifica
+static estado_slot_t ler_slot(posicao_t p) {
+    if (esp_partition_read(particao, endereco(p), slot_buf, tam_slot) != ESP_OK) {
+        return SLOT_INVALIDO;
+    }
+
+    bool apagado = true;
+    for (uint32_t i = 0; i < tam_slot; i++) {
+        if (slot_buf[i] != 0xFF) {
+            apagado = false;
+            break;
+        }
+    }
+    if (apagado) {
+        return SLOT_LIVRE;
+    }
+
+    if (ler_palavra(OFF_DADOS + tam_dados) != LOG_COMMIT ||
+        ler_palavra(OFF_CRC) != esp_rom_crc32_le(0, slot_buf + OFF_SEQ, 4 + tam_dados)) {
+        return SLOT_INVALIDO;  // Escrita interrompida por queda de energia
+    }
+    return ler_palavra(OFF_DADOS + tam_dados + 4) == PALAVRA_APAGADA ? SLOT_PENDENTE : SLOT_ENVIADO;
+}
+
+// Passa a escrever no próximo setor. Se ele ainda tem dados, o log está cheio
+// e as leituras mais antigas são descartadas.
+static esp_err_t abrir_proximo_setor(void) {
+    uint32_t proximo = (cabeca.setor + 1) % n_setores;
+    cab_setor_t cab;
+
+    if (setor_valido(proximo, &cab)) {
+        uint32_t descartados = 0;
+        for (uint32_t slot = 0; slot < slots_por_setor; slot++) {
+            if (ler_slot((posicao_t){ proximo, slot }) == SLOT_PENDENTE) {
+                descartados++;
+            }
+        }
+        if (descartados > 0) {
+            ESP_LOGW(TAG, "Log cheio: %lu leituras antigas descartadas", (unsigned long)descartados);
+            perdidos += descartados;
+            pendentes -= descartados;
+        }
+        if (cauda.setor == proximo) {
+            cauda = (posicao_t){ (proximo + 1) % n_setores, 0 };
+        }
+    }
+
+    esp_err_t err = esp_partition_erase_range(particao, (size_t)proximo * SETOR_TAM, SETOR_TAM);
+    if (err != ESP_OK) {
+        return err;
+    }
+    cab = (cab_setor_t){
+        .magic = LOG_MAGIC,
+        .seq = seq_setor_cabeca + 1,
+        .tam_slot = tam_slot,
+        .reservado = PALAVRA_APAGADA,
+    };
+    err = esp_partition_write(particao, (size_t)proximo * SETOR_TAM, &cab, sizeof(cab));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    seq_setor_cabeca = cab.seq;
+    cabeca = (posicao_t){ proximo, 0 };
+    if (pendentes == 0) {
+        cauda = cabeca;
+    }
+    return ESP_OK;
+}
+
+esp_err_t offline_log_init(size_t tamanho_registro) {
+    if (tamanho_registro == 0 || tamanho_registro > OFFLINE_LOG_REGISTRO_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    particao = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "pluvlog");
+    if (particao == NULL) {
+        ESP_LOGE(TAG, "Partição pluvlog não encontrada");
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    tam_registro = tamanho_registro;
+    tam_dados = (tamanho_registro + 3) & ~3u;
+    tam_slot = OFF_DADOS + tam_dados + 8;
+    n_setores = particao->size / SETOR_TAM;
+    slots_por_setor = (SETOR_TAM - CAB_SETOR_TAM) / tam_slot;
+    if (n_setores < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // O setor com a maior sequência é o que está sendo escrito
+    bool achou = false;
+    cab_setor_t cab;
+    for (uint32_t setor = 0; setor < n_setores; setor++) {
+        if (setor_valido(setor, &cab) && (!achou || (int32_t)(cab.seq - seq_setor_cabeca) > 0)) {
+            achou = true;
+            cabeca.setor = setor;
+            seq_setor_cabeca = cab.seq;
+        }
+    }
+    pendentes = 0;
+    perdidos = 0;
+    proximo_seq = 0;
+
+    if (!achou) {
+        // Partição vazia ou em formato antigo: começa do zero
+        cabeca = (posicao_t){ n_setores - 1, 0 };
+        seq_setor_cabeca = 0;
+        cauda = cabeca;
+        return abrir_proximo_setor();
+    }
+
+    // Percorre do setor mais antigo até a cabeça achando a cauda, a posição livre e as pendências
+    bool cauda_achada = false;
+    cabeca.slot = slots_por_setor;
+    for (uint32_t i = 1; i <= n_setores; i++) {
+        uint32_t setor = (cabeca.setor + i) % n_setores;
+        if (!setor_valido(setor, &cab)) {
+            continue;
+        }
+        for (uint32_t slot = 0; slot < slots_por_setor; slot++) {
+            posicao_t p = { setor, slot };
+            estado_slot_t estado = ler_slot(p);
+            if (estado == SLOT_LIVRE) {
+                if (setor == cabeca.setor) {
+                    cabeca.slot = slot;
+                }
+                break;
+            }
+            if (estado == SLOT_INVALIDO) {
+                continue;
+            }
+            uint32_t seq = ler_palavra(OFF_SEQ);
+            if ((int32_t)(seq + 1 - proximo_seq) > 0) {
+                proximo_seq = seq + 1;
+            }
+            if (estado == SLOT_PENDENTE) {
+                pendentes++;
+                if (!cauda_achada) {
+                    cauda = p;
+                    cauda_achada = true;
+                }
+            }
+        }
+    }
+
+    esp_err_t err = ESP_OK;
+    if (cabeca.slot >= slots_por_setor) {
+        err = abrir_proximo_setor();
+    }
+    if (!cauda_achada) {
+        cauda = cabeca;
+    }
+
+    ESP_LOGI(TAG, "Log offline: %lu setores de %lu slots, %lu leituras pendentes",
+             (unsigned long)n_setores, (unsigned long)slots_por_setor, (unsigned long)pendentes);
+    return err;
+}
+
+esp_err_t offline_log_append(const void *registro) {
+    if (particao == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(slot_buf, 0, OFF_DADOS + tam_dados);
+    memcpy(slot_buf + OFF_SEQ, &proximo_seq, sizeof(proximo_seq));
+    memcpy(slot_buf + OFF_DADOS, registro, tam_registro);
+    uint32_t crc = esp_rom_crc32_le(0, slot_buf + OFF_SEQ, 4 + tam_dados);
+    memcpy(slot_buf + OFF_CRC, &crc, sizeof(crc));
+
+    // Dados primeiro, commit depois: sem o commit o slot é ignorado na leitura
+    size_t endereco_slot = endereco(cabeca);
+    esp_err_t err = esp_partition_write(particao, endereco_slot, slot_buf, OFF_DADOS + tam_dados);
+    if (err == ESP_OK) {
+        uint32_t commit = LOG_COMMIT;
+        err = esp_partition_write(particao, endereco_slot + OFF_DADOS + tam_dados, &commit, sizeof(commit));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao gravar leitura: %s", esp_err_to_name(err));
+    } else {
+        proximo_seq++;
+        pendentes++;
+    }
+    cabeca.slot++;  // Mesmo com falha: não reaproveita um slot parcialmente gravado
+
+    if (cabeca.slot >= slots_por_setor) {
+        esp_err_t err_setor = abrir_proximo_setor();
+        if (err == ESP_OK) {
+            err = err_setor;
+        }
+    }
+    return err;
+}
+
+size_t offline_log_peek(void *destino, size_t max) {
+    size_t n = 0;
+    posicao_t p = cauda;
+
+    while (n < max && !mesma_posicao(p, cabeca)) {
+        if (ler_slot(p) == SLOT_PENDENTE) {
+            memcpy((uint8_t *)destino + n * tam_registro, slot_buf + OFF_DADOS, tam_registro);
+            n++;
+        }
+        avancar(&p);
+    }
+    return n;
+}
+
+esp_err_t offline_log_consume(size_t n) {
+    uint32_t enviado = 0;
+
+    while (n > 0 && !mesma_posicao(cauda, cabeca)) {
+        if (ler_slot(cauda) == SLOT_PENDENTE) {
+            esp_err_t err = esp_partition_write(particao, endereco(cauda) + OFF_DADOS + tam_dados + 4,
+                                                &enviado, sizeof(enviado));
+            if (err != ESP_OK) {
+                return err;
+            }
+            pendentes--;
+            n--;
+        }
+        avancar(&cauda);
+    }
+    if (pendentes == 0) {
+        cauda = cabeca;
+    }
+    return ESP_OK;
+}
+
+uint32_t offline_log_pending(void) {
+    return pendentes;
+}
+
+uint32_t offline_log_lost(void) {
+    return perdidos;
+}
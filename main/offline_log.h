@@ -0,0 +1,31 @@
+#ifndef OFFLINE_LOG_H
+#define OFFLINE_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Log circular de registros de tamanho fixo na partição "pluvlog", para guardar as
+// leituras enquanto o WiFi está fora. Só acrescenta: cada setor é apagado uma vez por
+// volta completa, o que distribui o desgaste pela partição inteira. Um registro só é
+// válido depois que a palavra de commit é gravada com o CRC conferindo, então uma queda
+// de energia no meio da escrita perde no máximo o registro em andamento.
+// Não é thread-safe: é usado apenas pela task de envio.
+
+#define OFFLINE_LOG_REGISTRO_MAX 64
+
+esp_err_t offline_log_init(size_t tamanho_registro);
+
+// Acrescenta um registro; com o log cheio, o setor mais antigo é descartado
+esp_err_t offline_log_append(const void *registro);
+
+// Copia até max registros pendentes, do mais antigo ao mais novo, sem removê-los
+size_t offline_log_peek(void *destino, size_t max);
+
+// Marca como enviados os n registros pendentes mais antigos
+esp_err_t offline_log_consume(size_t n);
+
+uint32_t offline_log_pending(void);
+uint32_t offline_log_lost(void);
+
+#endif
@@ -0,0 +1,114 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "power.h"
+#include "uplink_http.h"
+
+static const char* TAG = "POWER";
+
+#if CONFIG_PM_PROFILING
+// Corrente típica de cada modo do esp_pm, da folha de dados do ESP32 (um núcleo
+// ativo, rádio em modem sleep). O rádio transmitindo ou recebendo não aparece nos
+// modos do PM; é estimado pelo tempo das requisições HTTP.
+#define CORRENTE_RADIO_UA 100000
+
+static const struct {
+    const char *modo;     // Nome usado pelo esp_pm_dump_locks
+    const char *descricao;
+    uint32_t corrente_ua;
+} modos[] = {
+    { "SLEEP", "light sleep", 800 },
+    { "APB_MIN", "freq. mínima", 13000 },
+    { "APB_MAX", "80 MHz", 20000 },
+    { "CPU_MAX", "freq. máxima", 27000 },
+};
+#define NUM_MODOS (sizeof(modos) / sizeof(modos[0]))
+
+static int64_t tempo_anterior_us[NUM_MODOS];
+static int64_t radio_anterior_us = 0;
+#endif
+
+esp_err_t power_init(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_PLUVIO_PM_FREQ_MIN_MHZ,
+#if CONFIG_PLUVIO_PM_LIGHT_SLEEP
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "DFS entre %d e %d MHz, light sleep automático %s",
+                 config.min_freq_mhz, config.max_freq_mhz, config.light_sleep_enable ? "ligado" : "desligado");
+    } else {
+        ESP_LOGE(TAG, "Falha ao configurar o gerenciamento de energia: %s", esp_err_to_name(err));
+    }
+    return err;
+#else
+    return ESP_OK;
+#endif
+}
+
+void power_relatorio(void) {
+#if CONFIG_PM_PROFILING
+    // O esp_pm só expõe as estatísticas como texto
+    char *texto = NULL;
+    size_t tamanho = 0;
+    FILE *f = open_memstream(&texto, &tamanho);
+    if (f == NULL) {
+        return;
+    }
+    esp_pm_dump_locks(f);
+    fclose(f);
+
+    int64_t delta_us[NUM_MODOS] = { 0 };
+    int64_t total_us = 0;
+    char *linha = texto != NULL ? strstr(texto, "Mode stats:") : NULL;
+    while (linha != NULL && (linha = strchr(linha, '\n')) != NULL) {
+        linha++;
+        char nome[16];
+        uint32_t freq_mhz;
+        int64_t tempo_us;
+        if (sscanf(linha, "%15s %" SCNu32 "M %" SCNd64, nome, &freq_mhz, &tempo_us) != 3) {
+            continue;
+        }
+        for (size_t i = 0; i < NUM_MODOS; i++) {
+            if (strcmp(nome, modos[i].modo) == 0) {
+                delta_us[i] = tempo_us - tempo_anterior_us[i];
+                tempo_anterior_us[i] = tempo_us;
+                total_us += delta_us[i];
+            }
+        }
+    }
+    free(texto);
+    if (total_us <= 0) {
+        return;
+    }
+
+    const uplink_http_stats_t *http = uplink_http_stats();
+    int64_t radio_total_us = http->total_connect_us + http->total_request_us;
+    int64_t radio_us = radio_total_us - radio_anterior_us;
+    radio_anterior_us = radio_total_us;
+
+    // Média ponderada pelo tempo em cada modo, mais o rádio ativo
+    int64_t carga_ua_us = radio_us * CORRENTE_RADIO_UA;
+    for (size_t i = 0; i < NUM_MODOS; i++) {
+        carga_ua_us += delta_us[i] * modos[i].corrente_ua;
+    }
+
+    ESP_LOGI(TAG, "Corrente média estimada: %lld uA em %lld s (%s %lld%%, %s %lld%%, %s %lld%%, %s %lld%%, rádio %lld ms)",
+             carga_ua_us / total_us, total_us / 1000000,
+             modos[0].descricao, delta_us[0] * 100 / total_us,
+             modos[1].descricao, delta_us[1] * 100 / total_us,
+             modos[2].descricao, delta_us[2] * 100 / total_us,
+             modos[3].descricao, delta_us[3] * 100 / total_us,
+             radio_us / 1000);
+#endif
+}
@@ -0,0 +1,17 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "esp_err.h"
+
+// Perfil de energia: frequência dinâmica (DFS) e light sleep automático no idle.
+// Os módulos seguram locks de PM só enquanto precisam: o envio HTTP e as rajadas
+// de bordas do sensor.
+
+// Configura o esp_pm conforme o menuconfig; sem CONFIG_PM_ENABLE não faz nada
+esp_err_t power_init(void);
+
+// Registra no log o tempo em cada modo de energia desde o último relatório e a
+// corrente média estimada a partir dele. Precisa de CONFIG_PM_PROFILING.
+void power_relatorio(void);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_eth.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+
+#include "heap_track.h"
+#include "qemu_teste.h"
+#include "tip_counter.h"
+#include "wifi_manager.h"
+
+#if CONFIG_PLUVIO_QEMU
+#define CONSOLE_UART CONFIG_ESP_CONSOLE_UART_NUM
+#define LINHA_MAX 64
+
+static const char* TAG = "QEMU_TESTE";
+
+static esp_eth_handle_t eth = NULL;
+
+// Mesmos bits que o wifi_manager publica, para o envio não distinguir as redes
+static void publicar(EventBits_t bits) {
+    xEventGroupClearBits(s_wifi_event_group, WIFI_ESTADO_BITS & ~bits);
+    xEventGroupSetBits(s_wifi_event_group, bits);
+}
+
+static void eth_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    if (event_base == IP_EVENT && event_id == IP_EVENT_ETH_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        printf("PLUVQEMU ip " IPSTR "\n", IP2STR(&event->ip_info.ip));
+        publicar(WIFI_CONNECTED_BIT);
+    } else if (event_base == ETH_EVENT && event_id == ETHERNET_EVENT_DISCONNECTED) {
+        ESP_LOGW(TAG, "Ethernet desconectada");
+        publicar(WIFI_CONECTANDO_BIT);
+    }
+}
+
+// Ethernet OpenCores emulada pelo QEMU (-nic user,model=open_eth), como no
+// protocol_examples_common do ESP-IDF
+static esp_err_t iniciar_rede(void) {
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    esp_netif_config_t netif_config = ESP_NETIF_DEFAULT_ETH();
+    esp_netif_t *netif = esp_netif_new(&netif_config);
+
+    eth_mac_config_t mac_config = ETH_MAC_DEFAULT_CONFIG();
+    eth_phy_config_t phy_config = ETH_PHY_DEFAULT_CONFIG();
+    phy_config.autonego_timeout_ms = 100;
+    esp_eth_mac_t *mac = esp_eth_mac_new_openeth(&mac_config);
+    esp_eth_phy_t *phy = esp_eth_phy_new_dp83848(&phy_config);
+    esp_eth_config_t eth_config = ETH_DEFAULT_CONFIG(mac, phy);
+
+    esp_err_t err = esp_eth_driver_install(&eth_config, &eth);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_ERROR_CHECK(esp_netif_attach(netif, esp_eth_new_netif_glue(eth)));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_ETH_GOT_IP, eth_event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(ETH_EVENT, ETHERNET_EVENT_DISCONNECTED, eth_event_handler, NULL));
+    publicar(WIFI_CONECTANDO_BIT);
+    return esp_eth_start(eth);
+}
+
+// Basculadas no ritmo pedido: o contato fica largura_ms no nível ativo, uma a cada
+// periodo_ms. Os tempos são arredondados para o tick do FreeRTOS.
+static void injetar_pulsos(uint32_t n, uint32_t periodo_ms, uint32_t largura_ms) {
+    TickType_t largura = pdMS_TO_TICKS(largura_ms);
+    TickType_t periodo = pdMS_TO_TICKS(periodo_ms);
+    if (n == 0 || largura == 0 || periodo <= largura) {
+        printf("PLUVQEMU erro pulsos: n > 0 e periodo > largura >= %u ms\n", (unsigned)portTICK_PERIOD_MS);
+        return;
+    }
+
+    int ativo = tip_counter_debounce_config()->nivel_ativo;
+    uint32_t aceitas = 0;
+    int64_t inicio_us = esp_timer_get_time();
+    TickType_t proximo = xTaskGetTickCount();
+    for (uint32_t i = 0; i < n; i++) {
+        tip_counter_isr_injetar(ativo);
+        vTaskDelay(largura);
+        aceitas += tip_counter_isr_injetar(!ativo);
+        vTaskDelayUntil(&proximo, periodo);
+    }
+    printf("PLUVQEMU pulsos injetadas=%lu aceitas=%lu duracao_ms=%lld\n", (unsigned long)n,
+           (unsigned long)aceitas, (esp_timer_get_time() - inicio_us) / 1000);
+}
+
+static void executar(char *linha) {
+    unsigned long n, periodo_ms, largura_ms;
+    if (sscanf(linha, "pulsos %lu %lu %lu", &n, &periodo_ms, &largura_ms) == 3) {
+        injetar_pulsos(n, periodo_ms, largura_ms);
+    } else if (strcmp(linha, "heap") == 0) {
+        heap_track_amostra_t heap;
+        heap_track_amostrar(&heap);
+        printf("PLUVQEMU heap livre=%lu livre_minimo=%lu maior_bloco=%lu\n", (unsigned long)heap.livre,
+               (unsigned long)heap.livre_minimo, (unsigned long)heap.maior_bloco);
+    } else if (linha[0] != '\0') {
+        printf("PLUVQEMU erro comando: %s\n", linha);
+    }
+}
+
+// Lê o console uma linha por vez. O driver só é instalado para a leitura; o log
+// continua saindo direto pela UART.
+static void console_task(void *pvParameter) {
+    char linha[LINHA_MAX];
+    size_t len = 0;
+    ESP_ERROR_CHECK(uart_driver_install(CONSOLE_UART, 256, 0, 0, NULL, 0));
+    printf("PLUVQEMU pronto\n");
+
+    while (1) {
+        char c;
+        if (uart_read_bytes(CONSOLE_UART, &c, 1, portMAX_DELAY) != 1) {
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            linha[len] = '\0';
+            executar(linha);
+            len = 0;
+        } else if (len < sizeof(linha) - 1) {
+            linha[len++] = c;
+        }
+    }
+}
+
+void qemu_teste_iniciar(void) {
+    if (s_wifi_event_group == NULL) {
+        s_wifi_event_group = xEventGroupCreate();
+    }
+    esp_err_t err = iniciar_rede();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar a Ethernet do QEMU: %s", esp_err_to_name(err));
+    }
+
+    heap_sub_t marca = heap_track_entrar(HEAP_SUB_TASKS);
+    xTaskCreate(console_task, "qemu_teste", 3072, NULL, 5, NULL);
+    heap_track_sair(marca);
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef QEMU_TESTE_H
+#define QEMU_TESTE_H
+
+#include "sdkconfig.h"
+
+// Modo de teste no QEMU do esp32 (pytest_qemu_pluviometro.py). No lugar do WiFi, que o
+// QEMU não emula, sobe a Ethernet OpenCores do QEMU com DHCP e publica a conexão no
+// mesmo grupo de eventos do WiFi, de modo que o envio funciona sem mudanças. Um
+// console na UART recebe comandos do teste, uma linha por comando:
+//
+//   pulsos <n> <periodo_ms> <largura_ms>   Injeta n basculadas no backend ISR
+//   heap                                   Estado do heap
+//
+// As respostas são linhas "PLUVQEMU ..." para o teste ler.
+
+#if CONFIG_PLUVIO_QEMU
+// Inicia a rede e o console; chamada no lugar de start_wifi_configuration
+void qemu_teste_iniciar(void);
+#endif
+
+#endif
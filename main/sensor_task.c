@@ -1,10 +1,30 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "esp_http_client.h"
+#include "esp_timer.h"
+#include "esp_netif_sntp.h"
+#include "nvs.h"
+#include <string.h>
+#include <time.h>
 
+#include "app_config.h"
+#include "deep_sleep.h"
+#include "diag.h"
+#include "leitura.h"
+#include "offline_log.h"
+#include "power.h"
+#include "rain_agg.h"
+#include "report_sched.h"
 #include "sensor_task.h"
+#include "tip_counter.h"
+#include "trace.h"
+#include "uplink_batch.h"
+#include "uplink_bin.h"
+#include "uplink_codec.h"
+#include "uplink_http.h"
 #include "wifi_manager.h"
 
 
@@ -17,72 +37,589 @@
 #define CONFIG_LOG_MAXIMUM_LEVEL ESP_LOG_VERBOSE
 #endif
 
-#define SENSOR_PIN GPIO_NUM_4
 static const char* TAG = "SENSOR_TASK";
 
 static const char *TAG2 = "thing_speak";
-#define THINGSPEAK_API_KEY "IJDIGYQD9KKACLAH"
-#define THINGSPEAK_URL "http://api.thingspeak.com/update?api_key="
+#define QUERY_MAX_LEN (UPLINK_FORM_BYTES + DIAG_STATUS_MAX)
+
+#define OFFLINE_REPLAY_MS (app_config()->offline_replay_ms)
+#define RELOGIO_VALIDO_APOS 1700000000  // Antes disso o SNTP ainda não sincronizou
+#define EVENTOS_LOTE CONFIG_PLUVIO_TIP_RING_SIZE
+#define RELATORIO_ENERGIA_US 3600000000LL  // Relatório de energia a cada hora
+
+#if CONFIG_PLUVIO_UPLINK_BATCH
+#define THINGSPEAK_BULK_CAMINHO "/channels/%s/bulk_update.json"  // No host da URL de envio
+#define LOTE_TAMANHO CONFIG_PLUVIO_BATCH_TAMANHO
+#define LOTE_INTERVALO_US (CONFIG_PLUVIO_BATCH_INTERVALO_S * 1000000LL)
+#define LOTE_CORPO_MAX (UPLINK_BATCH_BYTES_FIXOS + LOTE_TAMANHO * UPLINK_BATCH_BYTES_POR_LEITURA + \
+                        UPLINK_BATCH_BYTES_STATUS + DIAG_STATUS_MAX)
+#else
+#define LOTE_TAMANHO 1
+#endif
+
+// Formato do envio (uplink_codec.h) e tamanho da maior requisição
+#if CONFIG_PLUVIO_UPLINK_BINARIO
+#define UPLINK_CODEC uplink_codec_bin
+#define UPLINK_CORPO_MAX UPLINK_BIN_BYTES(LOTE_TAMANHO)
+#define UPLINK_POR_POST 1
+#elif CONFIG_PLUVIO_UPLINK_BATCH
+#define UPLINK_CODEC uplink_codec_json
+#define UPLINK_CORPO_MAX LOTE_CORPO_MAX
+#define UPLINK_POR_POST 1
+#else
+#define UPLINK_CODEC uplink_codec_form
+#define UPLINK_CORPO_MAX QUERY_MAX_LEN
+#define UPLINK_POR_POST 0
+#endif
+
+// No modo deep sleep o estado entre envios fica na memória RTC, que sobrevive ao sono
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+#define PERSISTENTE RTC_DATA_ATTR
+#define SONO_ESPERA_WIFI_MS CONFIG_PLUVIO_SONO_ESPERA_WIFI_MS
+#else
+#define PERSISTENTE
+#endif
 
-int contador = 0;
-int ultimo_estado = 1;
 float precipitacao = 0;
 
+static PERSISTENTE rain_agg_t agregado;
+static uint32_t eventos_lote[EVENTOS_LOTE];
+static PERSISTENTE uint32_t descartados_agregados = 0;
+static PERSISTENTE uint16_t numero_boot = 0;
+
+#if CONFIG_PLUVIO_UPLINK_BATCH
+static PERSISTENTE leitura_t lote[LOTE_TAMANHO];
+static PERSISTENTE size_t lote_n = 0;
+static PERSISTENTE int64_t lote_inicio_us = 0;
+#endif
+
+static PERSISTENTE int64_t ultimo_envio_us = 0;
+static PERSISTENTE uint32_t basculadas_intervalo = 0;
+
+// Intervalo de envio conforme a intensidade da chuva
+static PERSISTENTE report_sched_t agenda;
+
+static TaskHandle_t task_envio = NULL;
+
+// Resultado do backend->init, para a task de envio não dormir antes do ULP carregado
+#define SENSOR_PRONTO_BIT BIT0
+#define SENSOR_FALHOU_BIT BIT1
+#define SENSOR_ESPERA_INIT_MS 10000
+static StaticEventGroup_t sensor_estado_buffer;
+static EventGroupHandle_t sensor_estado = NULL;
+
+// Relógio das leituras: o uptime, ou no modo deep sleep um relógio que continua
+// contando enquanto o processador dorme
+static int64_t relogio_us(void) {
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+    return deep_sleep_relogio_us();
+#else
+    return esp_timer_get_time();
+#endif
+}
+
+void sensor_task_preparar(void) {
+    sensor_estado = xEventGroupCreateStatic(&sensor_estado_buffer);
+}
+
 void sensor_task(void *pvParameter){
-    gpio_reset_pin(SENSOR_PIN);  
-    gpio_set_direction(SENSOR_PIN, GPIO_MODE_INPUT);
+    const tip_counter_backend_t *backend = tip_counter_backend();
+
+    if (backend->init(app_config()->pino_sensor) != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao inicializar o contador '%s'", backend->nome);
+        xEventGroupSetBits(sensor_estado, SENSOR_FALHOU_BIT);
+        vTaskDelete(NULL);
+        return;
+    }
+    xEventGroupSetBits(sensor_estado, SENSOR_PRONTO_BIT);
+
+    ESP_LOGI(TAG, "Sensor inicializado (contador '%s'). Aguardando eventos...", backend->nome);
+
+    if (backend->run == NULL) {
+        // O periférico conta sozinho; a task não tem mais nada a fazer
+        vTaskDelete(NULL);
+        return;
+    }
+    backend->run();
+}
+
+// Agenda de envios com os intervalos e limiares da configuração
+static void iniciar_agenda(uint32_t agora_s) {
+    const app_config_t *config = app_config();
+    report_sched_config_t agenda_config = {
+        .intervalo_seco_s = config->envio_seco_s,
+        .intervalo_chuva_s = config->envio_chuva_s,
+        .intervalo_forte_s = config->envio_forte_s,
+        .limiar_chuva = config->limiar_chuva_10min,
+        .limiar_forte = config->limiar_forte_10min,
+        .calmaria_s = config->calmaria_min * 60,
+    };
+    report_sched_init(&agenda, &agenda_config, agora_s);
+}
+
+// Leva as basculadas novas para o agregador e para a contagem do intervalo.
+// Com backend de eventos cada basculada entra no segundo em que ocorreu; os eventos
+// perdidos com o buffer cheio e a contagem do PCNT entram no instante atual.
+static void agregar(int64_t agora_us) {
+    const tip_counter_backend_t *backend = tip_counter_backend();
+    tip_ring_t *ring = tip_counter_eventos();
+    uint32_t agora_ms = (uint32_t)(agora_us / 1000);
+    uint32_t agora_s = (uint32_t)(agora_us / 1000000);
+    uint32_t basculadas = backend->take();
+
+    if (basculadas > 0) {
+        TRACE(TRACE_AGREGADO, basculadas);
+    }
+    basculadas_intervalo += basculadas;
+    if (backend->run == NULL) {
+        rain_agg_add(&agregado, agora_s, basculadas);
+    } else {
+        size_t n;
+        while ((n = tip_ring_pop_many(ring, eventos_lote, EVENTOS_LOTE)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                // Diferença sem sinal: continua correta quando o contador de ms dá a volta.
+                // Eventos gravados depois da leitura do relógio contam no instante atual.
+                int32_t atraso_ms = (int32_t)(agora_ms - eventos_lote[i]);
+                uint32_t atraso_s = atraso_ms > 0 ? (uint32_t)atraso_ms / 1000 : 0;
+                rain_agg_add(&agregado, agora_s - atraso_s, 1);
+            }
+        }
+        uint32_t descartados = tip_ring_dropped(ring);
+        if (descartados != descartados_agregados) {
+            rain_agg_add(&agregado, agora_s, descartados - descartados_agregados);
+            ESP_LOGW(TAG, "%lu eventos perdidos no buffer (ocupação máxima %lu/%d)",
+                     (unsigned long)(descartados - descartados_agregados),
+                     (unsigned long)tip_ring_high_water(ring), EVENTOS_LOTE);
+            descartados_agregados = descartados;
+        }
+    }
+
+    rain_agg_advance(&agregado, agora_s);
+}
+
+// Lê e incrementa o número do boot guardado na NVS
+static uint16_t contar_boot(void) {
+    uint16_t boot = 0;
+    nvs_handle_t nvs_handle;
+    if (nvs_open("pluvio", NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        nvs_get_u16(nvs_handle, "boot", &boot);
+        boot++;
+        nvs_set_u16(nvs_handle, "boot", boot);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+    return boot;
+}
+
+static bool wifi_conectado(void) {
+    return s_wifi_event_group != NULL && (xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT);
+}
+
+static bool relogio_valido(time_t agora) {
+    return agora > RELOGIO_VALIDO_APOS;
+}
+
+// Sincroniza o relógio por SNTP na primeira conexão, para datar as leituras guardadas
+static void iniciar_relogio(void) {
+    static bool iniciado = false;
+    if (!iniciado) {
+        esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
+        iniciado = esp_netif_sntp_init(&config) == ESP_OK;
+    }
+}
+
+// Fecha o intervalo no agregador e monta a leitura que será enviada ou guardada
+static void medir(leitura_t *leitura, int64_t agora_us, uint32_t intervalo_s) {
+    agregar(agora_us);
+    uint32_t basculadas = basculadas_intervalo;
+    basculadas_intervalo = 0;
+    time_t agora = time(NULL);
+
+    precipitacao = rain_agg_mm_h(&agregado, basculadas, intervalo_s);
+
+    leitura->epoch_s = relogio_valido(agora) ? (uint32_t)agora : 0;
+    leitura->uptime_s = (uint32_t)(agora_us / 1000000);
+    leitura->boot = numero_boot;
+    leitura->basculadas = basculadas > UINT16_MAX ? UINT16_MAX : basculadas;
+    leitura->campos[0] = precipitacao;
+    leitura->campos[1] = rain_agg_mm_h(&agregado, agregado.maximo.total_1min, 60);
+    leitura->campos[2] = rain_agg_mm_h(&agregado, agregado.maximo.total_5min, 300);
+    leitura->campos[3] = rain_agg_mm(&agregado, agregado.soma.total_10min);
+    leitura->campos[4] = rain_agg_mm(&agregado, agregado.soma.total_1h);
+    leitura->campos[5] = rain_agg_mm(&agregado, agregado.soma.total_24h);
+    rain_agg_reset_max(&agregado);
+}
+
+// Horário da leitura. Se foi feita antes do SNTP, o horário é recuperado pelo
+// uptime quando ela é do boot atual; senão fica 0 e o servidor usa o da chegada.
+static uint32_t epoch_da_leitura(const leitura_t *leitura) {
+    time_t agora = time(NULL);
+    if (leitura->epoch_s == 0 && leitura->boot == numero_boot && relogio_valido(agora)) {
+        return (uint32_t)(agora - (time_t)((relogio_us() / 1000000) - leitura->uptime_s));
+    }
+    return leitura->epoch_s;
+}
+
+#if UPLINK_POR_POST
+// URL do POST: o caminho do formato no esquema e host da URL de envio individual,
+// para valer também um servidor local. NULL se falta configuração.
+static const char *url_post(void) {
+#if CONFIG_PLUVIO_UPLINK_BINARIO
+    static char url[APP_CONFIG_URL_MAX + sizeof(CONFIG_PLUVIO_UPLINK_BIN_CAMINHO)];
+#else
+    static char url[APP_CONFIG_URL_MAX + sizeof(THINGSPEAK_BULK_CAMINHO) + APP_CONFIG_CANAL_MAX];
+#endif
+    if (url[0] != '\0') {
+        return url;
+    }
+    const app_config_t *config = app_config();
+    const char *host = strstr(config->thingspeak_url, "://");
+    const char *caminho = host != NULL ? strchr(host + 3, '/') : NULL;
+    int host_len = caminho != NULL ? (int)(caminho - config->thingspeak_url) : (int)strlen(config->thingspeak_url);
+#if CONFIG_PLUVIO_UPLINK_BINARIO
+    snprintf(url, sizeof(url), "%.*s%s", host_len, config->thingspeak_url, CONFIG_PLUVIO_UPLINK_BIN_CAMINHO);
+#else
+    if (config->thingspeak_canal[0] == '\0') {
+        ESP_LOGE(TAG2, "O envio em lote precisa do ID do canal");
+        return NULL;
+    }
+    snprintf(url, sizeof(url), "%.*s" THINGSPEAK_BULK_CAMINHO, host_len, config->thingspeak_url,
+             config->thingspeak_canal);
+#endif
+    return url;
+}
+#endif
+
+// Envia leituras numa requisição, no formato escolhido no menuconfig. com_horario
+// manda o horário de cada leitura, para as que não saem na hora em que foram feitas
+// (guardadas ou acumuladas no lote). O status, se houver, vai na mais recente.
+static esp_err_t enviar(const leitura_t *leituras, size_t n, bool com_horario, const char *status) {
+    static uint8_t corpo[UPLINK_CORPO_MAX];
+    static uint32_t epochs[LOTE_TAMANHO];
+    const uplink_codec_t *codec = &UPLINK_CODEC;
+
+    for (size_t i = 0; i < n; i++) {
+        epochs[i] = com_horario ? epoch_da_leitura(&leituras[i]) : 0;
+    }
+    uplink_lote_t lote = { app_config()->thingspeak_api_key, leituras, epochs, n, status };
+    size_t len = codec->codificar(corpo, sizeof(corpo), &lote);
+    if (len == 0) {
+        ESP_LOGE(TAG2, "%u leituras não couberam em %u bytes (formato %s)", (unsigned)n,
+                 (unsigned)sizeof(corpo), codec->nome);
+        return ESP_ERR_NO_MEM;
+    }
+
+#if UPLINK_POR_POST
+    const char *url = url_post();
+    if (url == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = uplink_http_post(url, (const char *)corpo, len, codec->content_type);
+#else
+    esp_err_t err = uplink_http_get((const char *)corpo);
+#endif
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG2, "Falha ao enviar dados: %s", esp_err_to_name(err));
+    } else if (codec->content_type == NULL) {
+        ESP_LOGI(TAG2, "Dados enviados com sucesso: %s", (const char *)corpo);
+    } else {
+        ESP_LOGI(TAG2, "%u leituras enviadas (%s, %u bytes)", (unsigned)n, codec->nome, (unsigned)len);
+    }
+    return err;
+}
+
+// Reenvia as leituras guardadas mais antigas: uma por requisição, ou um lote inteiro
+// no modo em lote
+static void reenviar_guardada(void) {
+    static leitura_t leituras[LOTE_TAMANHO];
+    size_t n = offline_log_peek(leituras, LOTE_TAMANHO);
+    if (n == 0) {
+        return;
+    }
+    esp_err_t err = enviar(leituras, n, true, NULL);
+    if (err == ESP_OK) {
+        offline_log_consume(n);
+        ESP_LOGI(TAG, "%u leituras guardadas reenviadas; %lu pendentes",
+                 (unsigned)n, (unsigned long)offline_log_pending());
+    }
+}
+
+// Chamado pela task do contador a cada basculada
+static void avisar_basculada(void) {
+    xTaskNotifyGive(task_envio);
+}
 
-    ESP_LOGI(TAG, "Sensor inicializado. Aguardando eventos...");
-    
+// Espera até o prazo ou até a próxima basculada, o que vier antes. Com WiFi e
+// leituras guardadas, reenvia uma requisição a cada OFFLINE_REPLAY_MS, da mais antiga
+// para a mais nova. O ritmo dos reenvios é absoluto e vale entre chamadas: com chuva
+// forte cada basculada encerra a espera, e o log precisa esvaziar mesmo assim.
+static void aguardar_proximo_envio(int64_t prazo_us, bool log_disponivel) {
+    static int64_t proximo_reenvio_us = 0;
     while (1) {
-        int estado_atual = gpio_get_level(SENSOR_PIN);
+        int64_t agora_us = relogio_us();
+        if (agora_us >= prazo_us) {
+            TRACE(TRACE_DESPERTAR, TRACE_DESPERTAR_PRAZO);
+            return;
+        }
 
-        if (estado_atual == 0 && ultimo_estado == 1) {
-            contador++;
-            ESP_LOGI(TAG, "Borda de subida detectada. Contagem: %d", contador);
+        int64_t ate_us = prazo_us;
+        if (log_disponivel && offline_log_pending() > 0 && wifi_conectado()) {
+            // Respeita o intervalo mínimo entre requisições também em relação ao último envio
+            int64_t reenvio_us = ultimo_envio_us + OFFLINE_REPLAY_MS * 1000LL;
+            if (reenvio_us < proximo_reenvio_us) {
+                reenvio_us = proximo_reenvio_us;
+            }
+            if (agora_us >= reenvio_us) {
+                reenviar_guardada();
+                proximo_reenvio_us = relogio_us() + OFFLINE_REPLAY_MS * 1000LL;
+                continue;
+            }
+            if (reenvio_us < ate_us) {
+                ate_us = reenvio_us;
+            }
         }
 
-        if (estado_atual == 1 && ultimo_estado == 0) {
-            contador++;
-            ESP_LOGI(TAG, "Borda de descida detectada. Contagem: %d", contador);
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((ate_us - agora_us + 999) / 1000)) > 0) {
+            TRACE(TRACE_DESPERTAR, TRACE_DESPERTAR_BASCULADA);
+            return;
         }
+    }
+}
 
-        ultimo_estado = estado_atual;
-        // Adiciona um pequeno delay para permitir que o FreeRTOS gerencie outras tarefas
-        vTaskDelay(100 / portTICK_PERIOD_MS);  // 100 ms de delay
+// Reavalia o nível da agenda com a chuva dos últimos 10 minutos
+static void atualizar_agenda(uint32_t agora_s) {
+    report_nivel_t anterior = agenda.nivel;
+    report_nivel_t nivel = report_sched_atualizar(&agenda, agora_s, agregado.soma.total_10min);
+    if (nivel != anterior) {
+        ESP_LOGI(TAG, "Nível %s -> %s; envio a cada %lu s",
+                 report_sched_nome(anterior), report_sched_nome(nivel),
+                 (unsigned long)report_sched_intervalo_s(&agenda));
     }
 }
 
-void send_data_thingspeak(void *pvParameter) {
-    while (1) {
-        EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
-        if (bits & WIFI_CONNECTED_BIT) {
-            //vTaskDelay(900000 / portTICK_PERIOD_MS);  // 15 minutos de delay
-            vTaskDelay(60000 / portTICK_PERIOD_MS);  //60 segundss de delay
-            ESP_LOGI(TAG, "Conectado ao WiFi. Preparando para enviar dados...");
-            precipitacao = (contador * 1.63) * 4; 
-            contador = 0;
-
-            // Envio do dado para o ThingSpeak
-            static char url[256]; //memória estática global ou heap
-            snprintf(url, sizeof(url), THINGSPEAK_URL THINGSPEAK_API_KEY "&field1=%.2f", precipitacao);
-
-            esp_http_client_config_t config = {
-                .url = url,
-            };
-            esp_http_client_handle_t client = esp_http_client_init(&config);
-            esp_err_t err = esp_http_client_perform(client);
-
-            if (err == ESP_OK) {
-                ESP_LOGI(TAG2, "Dados enviados com sucesso: %s", url);
-            } else {
-                ESP_LOGE(TAG2, "Falha ao enviar dados: %s", esp_err_to_name(err));
+// Guarda leituras não enviadas no log offline, para reenvio quando o WiFi voltar
+static void guardar(const leitura_t *leituras, size_t n, bool log_disponivel) {
+    if (!log_disponivel) {
+        return;
+    }
+    size_t guardadas = 0;
+    while (guardadas < n && offline_log_append(&leituras[guardadas]) == ESP_OK) {
+        guardadas++;
+    }
+    if (guardadas > 0) {
+        ESP_LOGI(TAG, "%u leituras guardadas; %lu pendentes",
+                 (unsigned)guardadas, (unsigned long)offline_log_pending());
+    }
+}
+
+#if CONFIG_PLUVIO_UPLINK_BATCH
+// Acumula a leitura no lote e o envia quando junta LOTE_TAMANHO leituras ou quando a
+// mais antiga já esperou LOTE_INTERVALO_US. Sem WiFi o lote vai para o log offline.
+static void registrar_no_lote(const leitura_t *leitura, int64_t agora_us, bool log_disponivel) {
+    if (lote_n == 0) {
+        lote_inicio_us = agora_us;
+    }
+    lote[lote_n++] = *leitura;
+
+    if (lote_n < LOTE_TAMANHO && agora_us - lote_inicio_us < LOTE_INTERVALO_US) {
+        return;
+    }
+
+    if (wifi_conectado()) {
+        ESP_LOGI(TAG, "Conectado ao WiFi. Enviando lote de %u leituras...", (unsigned)lote_n);
+        iniciar_relogio();
+        char status[DIAG_STATUS_MAX];
+        diag_amostrar(status, sizeof(status));
+        if (enviar(lote, lote_n, true, status) != ESP_OK) {
+            guardar(lote, lote_n, log_disponivel);
+        }
+    } else {
+        ESP_LOGW(TAG, "Não conectado ao WiFi. Guardando o lote na flash...");
+        guardar(lote, lote_n, log_disponivel);
+    }
+    lote_n = 0;
+}
+#endif
+
+// true se a próxima leitura será enviada já, e não só acumulada no lote
+static bool publicacao_usa_rede(int64_t agora_us) {
+#if CONFIG_PLUVIO_UPLINK_BATCH
+    return lote_n + 1 >= LOTE_TAMANHO || (lote_n > 0 && agora_us - lote_inicio_us >= LOTE_INTERVALO_US);
+#else
+    return true;
+#endif
+}
+
+// Envia a leitura, ou a acumula no lote; o que não puder ser enviado vai para a flash
+static void publicar(const leitura_t *leitura, int64_t agora_us, bool log_disponivel) {
+#if CONFIG_PLUVIO_UPLINK_BATCH
+    registrar_no_lote(leitura, agora_us, log_disponivel);
+#else
+    if (wifi_conectado()) {
+        ESP_LOGI(TAG, "Conectado ao WiFi. Preparando para enviar dados...");
+        iniciar_relogio();
+        char status[DIAG_STATUS_MAX];
+        diag_amostrar(status, sizeof(status));
+        if (enviar(leitura, 1, false, status) == ESP_OK) {
+            return;
+        }
+    } else {
+        ESP_LOGW(TAG, "Não conectado ao WiFi. Guardando a leitura na flash...");
+    }
+    guardar(leitura, 1, log_disponivel);
+#endif
+}
+
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+// Um ciclo por despertar: mede, envia ou guarda e volta a dormir até o prazo da
+// agenda. O ULP conta as basculadas com os núcleos dormindo e acorda o processador
+// antes do prazo quando a chuva chegaria ao limiar do próximo nível, ou a
+// CONFIG_PLUVIO_SONO_LIMITE_BASCULADAS. Não retorna, exceto com o portal de
+// configuração ativo, quando o dispositivo precisa ficar acordado.
+static void ciclo_deep_sleep(bool log_disponivel) {
+    if (wifi_em_modo_ap()) {
+        ESP_LOGW(TAG, "Portal de configuração ativo; deep sleep suspenso");
+        return;
+    }
+
+    const tip_counter_backend_t *backend = tip_counter_backend();
+    int64_t agora_us = relogio_us();
+
+    uint32_t agora_s = (uint32_t)(agora_us / 1000000);
+
+    if (deep_sleep_acordou()) {
+        TRACE(TRACE_DESPERTAR, TRACE_DESPERTAR_SONO);
+        agregar(agora_us);
+        atualizar_agenda(agora_s);
+    }
+
+    if (deep_sleep_acordou() && report_sched_faltam_s(&agenda, agora_s) > 0) {
+        // Acordado pela chuva antes do prazo: o nível já foi reavaliado, volta a dormir
+        ESP_LOGI(TAG, "Despertar antecipado; próximo envio em %ld s",
+                 (long)report_sched_faltam_s(&agenda, agora_s));
+    } else if (deep_sleep_acordou()) {
+        uint32_t intervalo_s = (uint32_t)((agora_us - ultimo_envio_us) / 1000000);
+        ultimo_envio_us = agora_us;
+        report_sched_enviado(&agenda, agora_s);
+
+        leitura_t leitura;
+        medir(&leitura, agora_us, intervalo_s);
+        TRACE(TRACE_ENVIO_INICIO, intervalo_s);
+
+        // Só espera o WiFi se algo vai ser enviado; no lote incompleto dorme direto
+        if (publicacao_usa_rede(agora_us) && s_wifi_event_group != NULL) {
+            xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT | WIFI_DESISTIU_BIT,
+                                pdFALSE, pdFALSE, pdMS_TO_TICKS(SONO_ESPERA_WIFI_MS));
+            if (wifi_conectado()) {
+                iniciar_relogio();
+                if (!relogio_valido(time(NULL))) {
+                    esp_netif_sntp_sync_wait(pdMS_TO_TICKS(2000));
+                }
             }
-            esp_http_client_cleanup(client);
-        } else {
-            ESP_LOGE(TAG, "Não conectado ao WiFi. Tentando novamente em breve...");
-            vTaskDelay(10000 / portTICK_PERIOD_MS);  // Espera 10 segundos antes de tentar novamente
         }
+        publicar(&leitura, agora_us, log_disponivel);
+        TRACE(TRACE_ENVIO_FIM, 0);
+
+        // Aproveita o rádio ligado para adiantar as leituras guardadas
+        if (log_disponivel && offline_log_pending() > 0 && wifi_conectado()) {
+            vTaskDelay(pdMS_TO_TICKS(OFFLINE_REPLAY_MS));
+            reenviar_guardada();
+        }
+        uplink_http_close();
+    } else {
+        ultimo_envio_us = agora_us;  // Primeiro boot: o primeiro intervalo começa agora
+    }
+
+    bool acordar_pelo_ulp = CONFIG_PLUVIO_SONO_LIMITE_BASCULADAS > 0 && backend->despertar_apos != NULL;
+    if (acordar_pelo_ulp) {
+        uint32_t limite = CONFIG_PLUVIO_SONO_LIMITE_BASCULADAS;
+        uint32_t limiar = report_sched_proximo_limiar(&agenda);
+        if (limiar > agregado.soma.total_10min && limiar - agregado.soma.total_10min < limite) {
+            limite = limiar - agregado.soma.total_10min;
+        }
+        backend->despertar_apos(limite);
     }
+    deep_sleep_dormir(agora_us + report_sched_faltam_s(&agenda, agora_s) * 1000000LL, acordar_pelo_ulp);
 }
+#endif
+
+void send_data_thingspeak(void *pvParameter) {
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+    bool estado_preservado = deep_sleep_acordou();
+#else
+    bool estado_preservado = false;
+#endif
+    if (!estado_preservado) {
+        rain_agg_init(&agregado, app_config()->um_por_basculada);
+        numero_boot = contar_boot();
+        iniciar_agenda((uint32_t)(relogio_us() / 1000000));
+    }
+
+    static char url[APP_CONFIG_URL_MAX + APP_CONFIG_API_KEY_MAX];
+    snprintf(url, sizeof(url), "%s%s", app_config()->thingspeak_url, app_config()->thingspeak_api_key);
+    ESP_ERROR_CHECK(uplink_http_init(url));
+
+    bool log_disponivel = offline_log_init(sizeof(leitura_t)) == ESP_OK;
+    if (!log_disponivel) {
+        ESP_LOGE(TAG, "Log offline indisponível; leituras sem WiFi serão perdidas");
+    }
 
+#if CONFIG_PLUVIO_MODO_DEEP_SLEEP
+    // As tasks rodam em núcleos diferentes: sem esperar o init, o primeiro sono podia
+    // começar sem o programa do ULP, ou o carregamento zerar o limite já programado
+    EventBits_t bits = xEventGroupWaitBits(sensor_estado, SENSOR_PRONTO_BIT | SENSOR_FALHOU_BIT, pdFALSE,
+                                           pdFALSE, pdMS_TO_TICKS(SENSOR_ESPERA_INIT_MS));
+    if (!(bits & SENSOR_PRONTO_BIT)) {
+        // O ulp_init tenta carregar de novo no próximo despertar
+        ESP_LOGE(TAG, "Contador não inicializado; o sono não vai contar basculadas");
+    }
+    ciclo_deep_sleep(log_disponivel);
+#endif
+
+    // Os backends com task acordam esta task a cada basculada; com o PCNT a chuva é
+    // conferida no ritmo do intervalo mais curto
+    bool avisada = tip_counter_avisa();
+    if (avisada) {
+        task_envio = xTaskGetCurrentTaskHandle();
+        tip_counter_set_aviso(avisar_basculada);
+    }
+
+    ultimo_envio_us = relogio_us();
+    int64_t proximo_relatorio_us = ultimo_envio_us + RELATORIO_ENERGIA_US;
+
+    while (1) {
+        int64_t agora_us = relogio_us();
+        int64_t espera_us = report_sched_faltam_s(&agenda, (uint32_t)(agora_us / 1000000)) * 1000000LL;
+        if (!avisada && espera_us > agenda.cfg.intervalo_forte_s * 1000000LL) {
+            espera_us = agenda.cfg.intervalo_forte_s * 1000000LL;
+        }
+        aguardar_proximo_envio(agora_us + espera_us, log_disponivel);
+
+        agora_us = relogio_us();
+        uint32_t agora_s = (uint32_t)(agora_us / 1000000);
+        agregar(agora_us);
+        atualizar_agenda(agora_s);
+        if (report_sched_faltam_s(&agenda, agora_s) > 0) {
+            continue;
+        }
+
+        uint32_t intervalo_s = (uint32_t)((agora_us - ultimo_envio_us) / 1000000);
+        ultimo_envio_us = agora_us;
+        report_sched_enviado(&agenda, agora_s);
+
+        leitura_t leitura;
+        medir(&leitura, agora_us, intervalo_s);
+        TRACE(TRACE_ENVIO_INICIO, intervalo_s);
+
+        publicar(&leitura, agora_us, log_disponivel);
+        TRACE(TRACE_ENVIO_FIM, 0);
+
+        if (agora_us >= proximo_relatorio_us) {
+            power_relatorio();
+#if CONFIG_PLUVIO_TRACE
+            trace_despejar_serial();
+#endif
+            proximo_relatorio_us = agora_us + RELATORIO_ENERGIA_US;
+        }
+    }
+}
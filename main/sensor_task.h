@@ -1,8 +1,17 @@
 #ifndef SENSOR_TASK_H
 #define SENSOR_TASK_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cria o estado compartilhado pelas duas tasks; chamar antes de criá-las
+void sensor_task_preparar(void);
 void sensor_task(void *pvParameter);
 void send_data_thingspeak(void *pvParameter3);
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,37 @@
+#include "esp_log.h"
+#include "freertoscpp/static_task.hpp"
+
+#include "app_config.h"
+#include "sensor_task.h"
+#include "tasks.h"
+
+using augtons::freertos::static_task;
+using augtons::freertos::task_builder;
+
+static const char* TAG = "TASKS";
+
+// Pilhas e TCBs ficam no .bss: o consumo de RAM das tasks aparece no link
+static static_task<CONFIG_PLUVIO_PILHA_SENSOR> task_sensor;
+static static_task<CONFIG_PLUVIO_PILHA_ENVIO> task_envio;
+static static_task<CONFIG_PLUVIO_PILHA_BOTAO> task_botao;
+
+extern "C" void tasks_iniciar(void) {
+    const app_config_t *config = app_config();
+    sensor_task_preparar();
+
+    // Sensor no núcleo 0 (PRO CPU) e o resto no núcleo 1 (APP CPU), por padrão
+    TaskHandle_t sensor = task_builder<>("sensor_task").priority(5).core_id(config->nucleo_sensor)
+        .bind(task_sensor, sensor_task);
+    TaskHandle_t envio = task_builder<>("send_data_thingspeak").priority(5).core_id(config->nucleo_envio)
+        .bind(task_envio, send_data_thingspeak);
+    TaskHandle_t botao = task_builder<>("check_reset_button").priority(5).core_id(config->nucleo_botao)
+        .bind(task_botao, check_reset_button);
+
+    if (sensor == nullptr || envio == nullptr || botao == nullptr) {
+        ESP_LOGE(TAG, "Falha ao criar as tasks principais");
+        return;
+    }
+    ESP_LOGI(TAG, "Tasks criadas; pilhas estáticas de %u + %u + %u bytes",
+             (unsigned)task_sensor.stack_size(), (unsigned)task_envio.stack_size(),
+             (unsigned)task_botao.stack_size());
+}
@@ -0,0 +1,19 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cria as tasks principais (sensor, envio e botão de reset) com pilha e TCB
+// estáticos, dimensionados pelo menuconfig, nos núcleos da app_config
+void tasks_iniciar(void);
+
+// Task do botão de reset, definida em main.c
+void check_reset_button(void *pvParameter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+#include "sdkconfig.h"
+
+#include "tip_counter.h"
+
+_Static_assert((CONFIG_PLUVIO_TIP_RING_SIZE & (CONFIG_PLUVIO_TIP_RING_SIZE - 1)) == 0,
+               "CONFIG_PLUVIO_TIP_RING_SIZE precisa ser potência de 2");
+
+static uint32_t eventos_armazenamento[CONFIG_PLUVIO_TIP_RING_SIZE];
+static tip_ring_t eventos = {
+    .eventos = eventos_armazenamento,
+    .mascara = CONFIG_PLUVIO_TIP_RING_SIZE - 1,
+};
+
+static void (*volatile aviso_basculada)(void) = NULL;
+
+static const debounce_config_t debounce_config = {
+    .largura_min_us = CONFIG_PLUVIO_DEBOUNCE_LARGURA_MIN_MS * 1000,
+    .refratario_us = CONFIG_PLUVIO_DEBOUNCE_REFRATARIO_MS * 1000,
+    .taxa_max_por_min = CONFIG_PLUVIO_DEBOUNCE_TAXA_MAX_POR_MIN,
+    .nivel_ativo = CONFIG_PLUVIO_SENSOR_NIVEL_ATIVO,
+};
+
+// Função que retorna o backend de contagem selecionado no menuconfig
+const tip_counter_backend_t *tip_counter_backend(void) {
+#if CONFIG_PLUVIO_TIP_BACKEND_PCNT
+    return &tip_counter_pcnt;
+#elif CONFIG_PLUVIO_TIP_BACKEND_POLL
+    return &tip_counter_poll;
+#elif CONFIG_PLUVIO_TIP_BACKEND_ULP
+    return &tip_counter_ulp;
+#else
+    return &tip_counter_isr;
+#endif
+}
+
+tip_ring_t *tip_counter_eventos(void) {
+    return &eventos;
+}
+
+void tip_counter_set_aviso(void (*aviso)(void)) {
+    aviso_basculada = aviso;
+}
+
+void tip_counter_avisar(void) {
+    void (*aviso)(void) = aviso_basculada;
+    if (aviso != NULL) {
+        aviso();
+    }
+}
+
+bool tip_counter_avisa(void) {
+    return tip_counter_backend()->run != NULL;
+}
+
+const debounce_config_t *tip_counter_debounce_config(void) {
+    return &debounce_config;
+}
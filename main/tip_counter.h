@@ -0,0 +1,43 @@
+#ifndef TIP_COUNTER_H
+#define TIP_COUNTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "debounce.h"
+#include "sdkconfig.h"
+#include "tip_counter_backend.h"
+#include "tip_ring.h"
+
+// Backends do firmware (interface em tip_counter_backend.h) e o estado compartilhado
+// entre eles e o envio
+extern const tip_counter_backend_t tip_counter_pcnt;
+extern const tip_counter_backend_t tip_counter_poll;
+extern const tip_counter_backend_t tip_counter_isr;
+extern const tip_counter_backend_t tip_counter_ulp;
+
+// Backend escolhido no menuconfig
+const tip_counter_backend_t *tip_counter_backend(void);
+
+// Instante de cada basculada, preenchido pela sensor_task e consumido pelo envio.
+// Fica vazio nos backends PCNT e ULP, que só fornecem a contagem.
+tip_ring_t *tip_counter_eventos(void);
+
+// Aviso a cada basculada aceita, chamado da task dos backends ISR e polling para
+// acordar quem espera por chuva sem precisar consultar a contagem periodicamente.
+// Os backends sem task (PCNT, ULP) não avisam.
+void tip_counter_set_aviso(void (*aviso)(void));
+void tip_counter_avisar(void);
+bool tip_counter_avisa(void);
+
+// Parâmetros do filtro de ruído definidos no menuconfig
+const debounce_config_t *tip_counter_debounce_config(void);
+
+#if CONFIG_PLUVIO_QEMU
+// Teste em QEMU: entrega ao backend ISR uma borda sintética no nível dado, pelo mesmo
+// caminho da interrupção (filtro, fila e task). Na primeira chamada desliga a
+// interrupção do pino. Retorna true quando a borda completa uma basculada.
+bool tip_counter_isr_injetar(int nivel);
+#endif
+
+#endif
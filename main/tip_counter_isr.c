@@ -0,0 +1,180 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
+
+#include "debounce.h"
+#include "tip_accum.h"
+#include "tip_counter.h"
+#include "tip_fila.h"
+#include "trace.h"
+
+// Sem bordas por este tempo a rajada acabou e o light sleep volta a ser permitido
+#define RAJADA_SILENCIO_MS (2 * (CONFIG_PLUVIO_DEBOUNCE_REFRATARIO_MS + CONFIG_PLUVIO_DEBOUNCE_LARGURA_MIN_MS))
+
+static const char* TAG = "TIP_ISR";
+
+static int pino_sensor = -1;
+static debounce_t filtro;  // Só é alterado dentro da ISR
+
+static tip_accum_t contagem = TIP_ACCUM_INIT;
+
+#if CONFIG_PM_ENABLE
+// Da primeira borda até o fim da trepidação o processador fica fora do light sleep,
+// para que as bordas seguintes tenham o instante exato
+static esp_pm_lock_handle_t lock_rajada = NULL;
+static portMUX_TYPE rajada_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool rajada_ativa = false;
+static int64_t ultima_borda_us = 0;
+#endif
+
+// Filtra uma borda e repassa para a task se ela completa uma basculada válida
+static inline __attribute__((always_inline)) bool processar_borda(int64_t timestamp_us, int nivel,
+                                                                  BaseType_t *acordar_task) {
+    if (!debounce_edge(&filtro, timestamp_us, nivel)) {
+        return false;
+    }
+    TRACE(TRACE_BORDA, nivel);
+    tip_fila_push_from_isr(timestamp_us, acordar_task);  // Cheia: conta em tip_fila_perdidas
+    return true;
+}
+
+// ISR do pino do sensor: filtra a trepidação e repassa só as basculadas válidas para a task
+static void IRAM_ATTR sensor_isr_handler(void *arg) {
+    int64_t timestamp_us = esp_timer_get_time();
+    int nivel = gpio_get_level(pino_sensor);
+
+#if CONFIG_PLUVIO_PM_LIGHT_SLEEP
+    // Interrupção por nível, que também acorda do light sleep: passa a esperar o oposto
+    gpio_ll_set_intr_type(GPIO_LL_GET_HW(GPIO_PORT_0), pino_sensor,
+                          nivel ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+#endif
+#if CONFIG_PM_ENABLE
+    portENTER_CRITICAL_ISR(&rajada_mux);
+    ultima_borda_us = timestamp_us;
+    if (!rajada_ativa) {
+        rajada_ativa = true;
+        esp_pm_lock_acquire(lock_rajada);
+    }
+    portEXIT_CRITICAL_ISR(&rajada_mux);
+#endif
+
+    BaseType_t acordar_task = pdFALSE;
+    processar_borda(timestamp_us, nivel, &acordar_task);
+    if (acordar_task) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+#if CONFIG_PLUVIO_QEMU
+bool tip_counter_isr_injetar(int nivel) {
+    static bool pino_isolado = false;
+    if (!pino_isolado) {
+        gpio_intr_disable(pino_sensor);  // O filtro passa a ser só das bordas injetadas
+        pino_isolado = true;
+    }
+    BaseType_t acordar_task = pdFALSE;
+    bool aceita = processar_borda(esp_timer_get_time(), nivel, &acordar_task);
+    if (acordar_task) {
+        taskYIELD();
+    }
+    return aceita;
+}
+#endif
+
+static int isr_init(int pino) {
+    debounce_init(&filtro, tip_counter_debounce_config());
+
+#if CONFIG_PM_ENABLE
+    esp_err_t err_lock = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "tip_rajada", &lock_rajada);
+    if (err_lock != ESP_OK) {
+        return err_lock;
+    }
+#endif
+
+    pino_sensor = pino;
+    gpio_reset_pin(pino);
+    gpio_set_direction(pino, GPIO_MODE_INPUT);
+#if CONFIG_PLUVIO_PM_LIGHT_SLEEP
+    // No light sleep só interrupções por nível acordam o processador: a ISR alterna
+    // o nível esperado a cada borda, o que equivale a ANYEDGE
+    gpio_int_type_t proximo = gpio_get_level(pino) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+    gpio_set_intr_type(pino, proximo);
+    gpio_wakeup_enable(pino, proximo);
+    esp_sleep_enable_gpio_wakeup();
+#else
+    gpio_set_intr_type(pino, GPIO_INTR_ANYEDGE);  // As duas bordas alimentam o filtro
+#endif
+
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {  // INVALID_STATE: serviço já instalado
+        ESP_LOGE(TAG, "Falha ao instalar o serviço de ISR: %s", esp_err_to_name(err));
+        return err;
+    }
+    return gpio_isr_handler_add(pino, sensor_isr_handler, NULL);
+}
+
+#if CONFIG_PM_ENABLE
+// Libera o light sleep se não houve bordas nos últimos RAJADA_SILENCIO_MS
+static void encerrar_rajada(void) {
+    int64_t agora_us = esp_timer_get_time();
+    portENTER_CRITICAL(&rajada_mux);
+    bool encerrar = rajada_ativa && agora_us - ultima_borda_us >= RAJADA_SILENCIO_MS * 1000LL;
+    if (encerrar) {
+        rajada_ativa = false;
+        esp_pm_lock_release(lock_rajada);
+    }
+    portEXIT_CRITICAL(&rajada_mux);
+}
+#endif
+
+// Consome as basculadas entregues pela ISR; bloqueia enquanto não houver eventos
+static void isr_run(void) {
+    int64_t timestamp_us;
+    uint32_t perdidas_reportadas = 0;
+
+    tip_fila_consumidor();
+    while (1) {
+        TickType_t espera = portMAX_DELAY;
+#if CONFIG_PM_ENABLE
+        encerrar_rajada();
+        if (rajada_ativa) {
+            espera = pdMS_TO_TICKS(RAJADA_SILENCIO_MS);
+        }
+#endif
+        if (!tip_fila_pop(&timestamp_us, espera)) {
+            continue;
+        }
+
+        tip_accum_add(&contagem, xPortGetCoreID(), 1);
+        tip_ring_push(tip_counter_eventos(), (uint32_t)(timestamp_us / 1000));
+        TRACE(TRACE_BASCULADA, timestamp_us);
+        tip_counter_avisar();
+        uint32_t total = tip_accum_peek(&contagem);
+
+        ESP_LOGI(TAG, "Basculada detectada em %lld us. Contagem: %lu (ruído rejeitado: %lu curtos, %lu refratário, %lu taxa)",
+                 timestamp_us, (unsigned long)total, (unsigned long)filtro.rejeitadas_curtas,
+                 (unsigned long)filtro.rejeitadas_refratario, (unsigned long)filtro.rejeitadas_taxa);
+
+        uint32_t perdidas = tip_fila_perdidas();
+        if (perdidas != perdidas_reportadas) {
+            ESP_LOGW(TAG, "%lu basculadas descartadas com a fila cheia", (unsigned long)(perdidas - perdidas_reportadas));
+            perdidas_reportadas = perdidas;
+        }
+    }
+}
+
+static uint32_t isr_take(void) {
+    return tip_accum_take(&contagem);
+}
+
+const tip_counter_backend_t tip_counter_isr = {
+    .nome = "isr",
+    .init = isr_init,
+    .run = isr_run,
+    .take = isr_take,
+};
@@ -0,0 +1,114 @@
+#include "driver/pulse_cnt.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "tip_counter.h"
+
+#define PCNT_LIMITE_ALTO 32767  // Ponto de estouro; com accum_count o driver acumula além dele
+
+static const char* TAG = "TIP_PCNT";
+
+static pcnt_unit_handle_t unidade = NULL;
+static int ultimo_valor = 0;  // Valor lido no último take()
+
+// Desfaz a configuração parcial, para o init poder ser tentado de novo ou outro
+// backend assumir
+static esp_err_t pcnt_falhar(const char *etapa, esp_err_t err, pcnt_channel_handle_t canal) {
+    ESP_LOGE(TAG, "Falha ao %s: %s", etapa, esp_err_to_name(err));
+    if (canal != NULL) {
+        pcnt_del_channel(canal);
+    }
+    if (unidade != NULL) {
+        pcnt_del_unit(unidade);
+        unidade = NULL;
+    }
+    return err;
+}
+
+// Configura o PCNT para contar as bordas do pino com o filtro de glitch do hardware.
+// Em caso de erro retorna o código, como o isr_init, em vez de abortar.
+static int pcnt_init(int pino) {
+    pcnt_unit_config_t unit_config = {
+        .low_limit = -1,
+        .high_limit = PCNT_LIMITE_ALTO,
+        .flags.accum_count = true,
+    };
+    esp_err_t err = pcnt_new_unit(&unit_config, &unidade);
+    if (err != ESP_OK) {
+        unidade = NULL;
+        return pcnt_falhar("criar a unidade PCNT", err, NULL);
+    }
+
+    pcnt_glitch_filter_config_t filtro = {
+        .max_glitch_ns = CONFIG_PLUVIO_PCNT_GLITCH_NS,
+    };
+    err = pcnt_unit_set_glitch_filter(unidade, &filtro);
+    if (err != ESP_OK) {
+        return pcnt_falhar("configurar o filtro de glitch", err, NULL);
+    }
+
+    pcnt_chan_config_t chan_config = {
+        .edge_gpio_num = pino,
+        .level_gpio_num = -1,
+    };
+    pcnt_channel_handle_t canal = NULL;
+    err = pcnt_new_channel(unidade, &chan_config, &canal);
+    if (err != ESP_OK) {
+        return pcnt_falhar("criar o canal PCNT", err, NULL);
+    }
+
+    // Uma basculada por pulso: conta só a borda de liberação do contato.
+    // O filtro do PCNT só elimina glitches de microssegundos; a trepidação
+    // de milissegundos do reed switch exige o backend ISR ou polling.
+    bool libera_na_subida = CONFIG_PLUVIO_SENSOR_NIVEL_ATIVO == 0;
+    err = pcnt_channel_set_edge_action(canal,
+        libera_na_subida ? PCNT_CHANNEL_EDGE_ACTION_INCREASE : PCNT_CHANNEL_EDGE_ACTION_HOLD,
+        libera_na_subida ? PCNT_CHANNEL_EDGE_ACTION_HOLD : PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+    if (err != ESP_OK) {
+        return pcnt_falhar("configurar as bordas", err, canal);
+    }
+
+    // Sem o watch point no limite o acumulador não registra os estouros
+    err = pcnt_unit_add_watch_point(unidade, PCNT_LIMITE_ALTO);
+    if (err != ESP_OK) {
+        return pcnt_falhar("configurar o watch point", err, canal);
+    }
+
+    err = pcnt_unit_enable(unidade);
+    if (err == ESP_OK) {
+        err = pcnt_unit_clear_count(unidade);
+        if (err == ESP_OK) {
+            err = pcnt_unit_start(unidade);
+        }
+        if (err != ESP_OK) {
+            pcnt_unit_disable(unidade);
+        }
+    }
+    if (err != ESP_OK) {
+        pcnt_unit_remove_watch_point(unidade, PCNT_LIMITE_ALTO);  // pcnt_del_unit exige
+        return pcnt_falhar("iniciar a contagem", err, canal);
+    }
+
+    ultimo_valor = 0;
+    ESP_LOGI(TAG, "PCNT contando no GPIO %d (filtro de %d ns)", pino, CONFIG_PLUVIO_PCNT_GLITCH_NS);
+    return ESP_OK;
+}
+
+// O contador nunca é zerado: a diferença para a última leitura não perde
+// as bordas que chegam entre a leitura e o reset
+static uint32_t pcnt_take(void) {
+    int valor = 0;
+    if (unidade == NULL || pcnt_unit_get_count(unidade, &valor) != ESP_OK) {
+        return 0;
+    }
+    uint32_t delta = (uint32_t)(valor - ultimo_valor);
+    ultimo_valor = valor;
+    return delta;
+}
+
+const tip_counter_backend_t tip_counter_pcnt = {
+    .nome = "pcnt",
+    .init = pcnt_init,
+    .run = NULL,
+    .take = pcnt_take,
+};
@@ -0,0 +1,60 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "debounce.h"
+#include "tip_accum.h"
+#include "tip_counter.h"
+
+static const char* TAG = "TIP_POLL";
+
+static tip_accum_t contagem = TIP_ACCUM_INIT;
+static int pino_sensor = -1;
+static debounce_t filtro;
+
+static int poll_init(int pino) {
+    pino_sensor = pino;
+    debounce_init(&filtro, tip_counter_debounce_config());
+    gpio_reset_pin(pino);
+    gpio_set_direction(pino, GPIO_MODE_INPUT);
+    return ESP_OK;
+}
+
+// Laço de leitura periódica do pino (comportamento original da sensor_task)
+static void poll_run(void) {
+    int ultimo_estado = gpio_get_level(pino_sensor);
+
+    while (1) {
+        int estado_atual = gpio_get_level(pino_sensor);
+
+        if (estado_atual != ultimo_estado) {
+            int64_t agora_us = esp_timer_get_time();
+            if (debounce_edge(&filtro, agora_us, estado_atual)) {
+                tip_accum_add(&contagem, xPortGetCoreID(), 1);
+                tip_ring_push(tip_counter_eventos(), (uint32_t)(agora_us / 1000));
+                tip_counter_avisar();
+                uint32_t total = tip_accum_peek(&contagem);
+                ESP_LOGI(TAG, "Basculada detectada. Contagem: %lu (ruído rejeitado: %lu curtos, %lu refratário, %lu taxa)",
+                         (unsigned long)total, (unsigned long)filtro.rejeitadas_curtas,
+                         (unsigned long)filtro.rejeitadas_refratario, (unsigned long)filtro.rejeitadas_taxa);
+            }
+        }
+
+        ultimo_estado = estado_atual;
+        vTaskDelay(CONFIG_PLUVIO_POLL_PERIOD_MS / portTICK_PERIOD_MS);
+    }
+}
+
+static uint32_t poll_take(void) {
+    return tip_accum_take(&contagem);
+}
+
+const tip_counter_backend_t tip_counter_poll = {
+    .nome = "poll",
+    .init = poll_init,
+    .run = poll_run,
+    .take = poll_take,
+};
@@ -0,0 +1,109 @@
+#include "driver/rtc_io.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_periph.h"
+#include "ulp.h"
+#include "ulp_main.h"
+
+#include "tip_counter.h"
+#include "ulp_tips.h"
+
+// Leituras seguidas no nível novo para aceitar uma borda
+#define ULP_DEBOUNCE_AMOSTRAS (CONFIG_PLUVIO_DEBOUNCE_LARGURA_MIN_MS / CONFIG_PLUVIO_ULP_PERIODO_MS)
+
+static const char* TAG = "TIP_ULP";
+
+extern const uint8_t ulp_main_bin_start[] asm("_binary_ulp_main_bin_start");
+extern const uint8_t ulp_main_bin_end[] asm("_binary_ulp_main_bin_end");
+
+#define ULP_CARREGADO_MAGICO 0x554C5031  // "ULP1"
+
+static RTC_DATA_ATTR uint16_t ultima_leitura = 0;  // Valor de ulp_basculadas no último take()
+static RTC_DATA_ATTR uint32_t ulp_carregado = 0;   // ULP_CARREGADO_MAGICO depois do ulp_run
+
+// O programa só continua do sono anterior se foi carregado e o timer do ULP está ligado
+static bool ulp_rodando(void) {
+    return ulp_carregado == ULP_CARREGADO_MAGICO &&
+           REG_GET_BIT(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+}
+
+// No primeiro boot carrega e inicia o programa do ULP. Ao acordar do deep sleep ele
+// já está rodando com a contagem intacta na memória RTC; só é preciso lê-la. Se o
+// dispositivo dormiu sem o programa carregado, carrega agora.
+static int ulp_init(int pino) {
+    if (esp_reset_reason() == ESP_RST_DEEPSLEEP) {
+        if (ulp_rodando()) {
+            ESP_LOGI(TAG, "ULP já contando no GPIO %d desde antes do sono", pino);
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "ULP parado ao acordar; carregando o programa de novo");
+    }
+    ulp_carregado = 0;
+    if (!rtc_gpio_is_valid_gpio(pino)) {
+        ESP_LOGE(TAG, "GPIO %d não é um pino RTC; o ULP não consegue lê-lo", pino);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ulp_load_binary(0, ulp_main_bin_start,
+                                    (ulp_main_bin_end - ulp_main_bin_start) / sizeof(uint32_t));
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao carregar o programa do ULP: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // No modo RTC o pull do GPIO não vale mais: o repouso do contato vem do pull do RTC,
+    // para o lado oposto ao nível ativo
+    int nivel_ativo = CONFIG_PLUVIO_SENSOR_NIVEL_ATIVO;
+    rtc_gpio_hold_dis(pino);  // Solta o hold de uma carga anterior
+    rtc_gpio_init(pino);
+    rtc_gpio_set_direction(pino, RTC_GPIO_MODE_INPUT_ONLY);
+    if (nivel_ativo == 0) {
+        rtc_gpio_pulldown_dis(pino);
+        rtc_gpio_pullup_en(pino);
+    } else {
+        rtc_gpio_pullup_dis(pino);
+        rtc_gpio_pulldown_en(pino);
+    }
+    rtc_gpio_hold_en(pino);  // Mantém a configuração durante o sono
+
+    ulp_rtc_io = rtc_io_number_get(pino);
+    ulp_nivel_ativo = nivel_ativo;
+    ulp_nivel_esperado = !rtc_gpio_get_level(pino);
+    ulp_debounce_max = ULP_DEBOUNCE_AMOSTRAS;
+    ulp_debounce_contador = ULP_DEBOUNCE_AMOSTRAS;
+    ulp_basculadas = 0;
+    ulp_limite = 0;
+    ultima_leitura = 0;
+
+    ulp_set_wakeup_period(0, CONFIG_PLUVIO_ULP_PERIODO_MS * 1000);
+    err = ulp_run(&ulp_entry - RTC_SLOW_MEM);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Falha ao iniciar o ULP: %s", esp_err_to_name(err));
+        return err;
+    }
+    ulp_carregado = ULP_CARREGADO_MAGICO;
+
+    ESP_LOGI(TAG, "ULP contando no GPIO %d (RTC %lu) a cada %d ms, debounce de %d leituras",
+             pino, (unsigned long)ulp_rtc_io, CONFIG_PLUVIO_ULP_PERIODO_MS, ULP_DEBOUNCE_AMOSTRAS);
+    return ESP_OK;
+}
+
+// O ULP nunca zera a contagem: a diferença para a última leitura não perde basculadas
+static uint32_t ulp_take(void) {
+    return ulp_tips_delta((uint16_t)(ulp_basculadas & UINT16_MAX), &ultima_leitura);
+}
+
+static void ulp_despertar_apos(uint32_t basculadas) {
+    ulp_limite = ulp_tips_limite((uint16_t)(ulp_basculadas & UINT16_MAX), basculadas);
+}
+
+const tip_counter_backend_t tip_counter_ulp = {
+    .nome = "ulp",
+    .init = ulp_init,
+    .run = NULL,
+    .take = ulp_take,
+    .despertar_apos = ulp_despertar_apos,
+};
@@ -0,0 +1,25 @@
+#include "esp_attr.h"
+#include "freertoscpp/spsc_ring.hpp"
+
+#include "tip_fila.h"
+
+using augtons::freertos::spsc_ring;
+
+static spsc_ring<int64_t, TIP_FILA_LEN> fila;
+
+extern "C" void tip_fila_consumidor(void) {
+    fila.attach_consumer();
+}
+
+// Em IRAM como a ISR que a chama; o push do anel é sempre inline
+extern "C" IRAM_ATTR bool tip_fila_push_from_isr(int64_t timestamp_us, BaseType_t *acordar_task) {
+    return fila.push_from_isr(timestamp_us, acordar_task);
+}
+
+extern "C" bool tip_fila_pop(int64_t *timestamp_us, TickType_t espera) {
+    return fila.pop(*timestamp_us, espera);
+}
+
+extern "C" uint32_t tip_fila_perdidas(void) {
+    return fila.dropped();
+}
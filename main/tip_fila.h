@@ -0,0 +1,33 @@
+#ifndef TIP_FILA_H
+#define TIP_FILA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fila das basculadas entre a ISR do sensor e a task do backend ISR: um
+// spsc_ring do freertos-cpp. A ISR só copia o instante e publica o índice; o
+// kernel só é chamado para acordar a task quando ela está bloqueada esperando.
+
+#define TIP_FILA_LEN 32  // Basculadas que podem ficar pendentes entre a ISR e a task
+
+// Registra a task que chama tip_fila_pop (a atual)
+void tip_fila_consumidor(void);
+
+// Lado da ISR; false com a fila cheia (a basculada é contada em tip_fila_perdidas)
+bool tip_fila_push_from_isr(int64_t timestamp_us, BaseType_t *acordar_task);
+
+// Lado da task; false se nada chegou dentro da espera
+bool tip_fila_pop(int64_t *timestamp_us, TickType_t espera);
+
+uint32_t tip_fila_perdidas(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
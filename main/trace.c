@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include "mbedtls/base64.h"
+
+#include "trace.h"
+
+#if CONFIG_PLUVIO_TRACE
+#define TRACE_MAGIC 0x43525450  // "PTRC"
+#define TRACE_VERSAO 1
+#define REGISTROS_POR_PEDACO 16
+#define BYTES_POR_LINHA 48      // 64 caracteres de base64
+
+_Static_assert(sizeof(trace_registro_t) == 12, "o formato do despejo usa registros de 12 bytes");
+_Static_assert((TRACE_REGISTROS & (TRACE_REGISTROS - 1)) == 0 && TRACE_REGISTROS <= 16384,
+               "CONFIG_PLUVIO_TRACE_REGISTROS precisa ser potência de 2, até 16384");
+
+// Cabeçalho do despejo, seguido dos registros
+typedef struct {
+    uint32_t magic;
+    uint8_t versao;
+    uint8_t tam_registro;
+    uint16_t capacidade;
+    uint32_t cabeca;   // Índice do próximo registro: quantos já foram gravados
+    uint32_t agora_us; // Instante do despejo, no mesmo relógio dos registros
+} trace_cabecalho_t;
+
+trace_registro_t trace_anel[TRACE_REGISTROS];
+atomic_uint trace_cabeca = 0;
+
+size_t trace_despejar(trace_saida_t saida, void *ctx) {
+    uint32_t cabeca = atomic_load_explicit(&trace_cabeca, memory_order_acquire);
+    uint32_t inicio = cabeca > TRACE_REGISTROS ? cabeca - TRACE_REGISTROS : 0;
+
+    trace_cabecalho_t cab = {
+        .magic = TRACE_MAGIC,
+        .versao = TRACE_VERSAO,
+        .tam_registro = sizeof(trace_registro_t),
+        .capacidade = TRACE_REGISTROS,
+        .cabeca = cabeca,
+        .agora_us = (uint32_t)esp_timer_get_time(),
+    };
+    saida(&cab, sizeof(cab), ctx);
+
+    // Copia em pedaços para não segurar nada: quem grava continua gravando
+    trace_registro_t pedaco[REGISTROS_POR_PEDACO];
+    size_t n = 0, total = 0;
+    for (uint32_t i = inicio; i != cabeca; i++) {
+        // seq igual ao índice antes e depois da cópia: o registro não mudou no meio
+        volatile trace_registro_t *slot = &trace_anel[i & (TRACE_REGISTROS - 1)];
+        uint16_t antes = slot->seq;
+        atomic_thread_fence(memory_order_acquire);
+        trace_registro_t r = { .t_us = slot->t_us, .evento = slot->evento, .nucleo = slot->nucleo, .arg = slot->arg };
+        atomic_thread_fence(memory_order_acquire);
+        if (antes != (uint16_t)i || slot->seq != (uint16_t)i) {
+            continue;  // Sobrescrito, ou ainda sendo escrito
+        }
+        r.seq = antes;
+        pedaco[n++] = r;
+        if (n == REGISTROS_POR_PEDACO) {
+            saida(pedaco, n * sizeof(r), ctx);
+            total += n;
+            n = 0;
+        }
+    }
+    if (n > 0) {
+        saida(pedaco, n * sizeof(pedaco[0]), ctx);
+        total += n;
+    }
+    return total;
+}
+
+// Junta os pedaços em linhas de base64 inteiras
+typedef struct {
+    uint8_t buf[BYTES_POR_LINHA];
+    size_t n;
+} linha_t;
+
+static void emitir_linha(linha_t *l) {
+    unsigned char texto[BYTES_POR_LINHA * 4 / 3 + 4];
+    size_t len = 0;
+    if (l->n > 0 && mbedtls_base64_encode(texto, sizeof(texto), &len, l->buf, l->n) == 0) {
+        printf("%.*s\n", (int)len, (const char *)texto);
+    }
+    l->n = 0;
+}
+
+static void saida_serial(const void *dados, size_t len, void *ctx) {
+    linha_t *l = ctx;
+    const uint8_t *p = dados;
+    while (len > 0) {
+        size_t parte = BYTES_POR_LINHA - l->n < len ? BYTES_POR_LINHA - l->n : len;
+        memcpy(l->buf + l->n, p, parte);
+        l->n += parte;
+        p += parte;
+        len -= parte;
+        if (l->n == BYTES_POR_LINHA) {
+            emitir_linha(l);
+        }
+    }
+}
+
+void trace_despejar_serial(void) {
+    linha_t linha = { .n = 0 };
+    printf("==PLUVTRACE INICIO==\n");
+    size_t n = trace_despejar(saida_serial, &linha);
+    emitir_linha(&linha);
+    printf("==PLUVTRACE FIM== %u registros\n", (unsigned)n);
+}
+#endif
@@ -0,0 +1,85 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Rastreamento de latência dos caminhos críticos: um anel fixo na RAM com registros
+// (instante, evento, argumento), gravável de ISR e de qualquer núcleo sem lock.
+// Despejado em binário pela serial e em /trace no portal; tools/trace_decode.py
+// monta os histogramas. Sem CONFIG_PLUVIO_TRACE a macro TRACE some e os
+// argumentos nem são avaliados.
+
+// Os números fazem parte do formato do despejo: não renumerar
+typedef enum {
+    TRACE_BORDA = 1,         // ISR do sensor, borda aceita pelo filtro; arg = nível
+    TRACE_BASCULADA = 2,     // Task do contador, basculada contada; arg = instante da borda (us)
+    TRACE_AGREGADO = 3,      // Envio, basculadas levadas ao agregador; arg = quantidade
+    TRACE_DESPERTAR = 4,     // Envio, fim da espera; arg = trace_despertar_t
+    TRACE_ENVIO_INICIO = 5,  // Envio, leitura medida; arg = intervalo (s)
+    TRACE_ENVIO_FIM = 6,     // Envio, leitura enviada, guardada ou no lote
+    TRACE_HTTP_INICIO = 7,   // esp_http_client_perform; arg = método
+    TRACE_HTTP_FIM = 8,      // arg = status HTTP, ou 0 em erro de conexão
+    TRACE_WIFI_CONECTAR = 9, // esp_wifi_connect; arg = caminho (0 rápido, 1 completo)
+    TRACE_WIFI_IP = 10,      // IP obtido; arg = caminho
+    TRACE_WIFI_QUEDA = 11,   // Desconectado; arg = motivo do driver
+} trace_evento_t;
+
+typedef enum {
+    TRACE_DESPERTAR_PRAZO = 0,
+    TRACE_DESPERTAR_BASCULADA = 1,
+    TRACE_DESPERTAR_SONO = 2,    // Saída do deep sleep
+} trace_despertar_t;
+
+// Registro de 12 bytes, igual no anel e no despejo (little-endian)
+typedef struct {
+    uint32_t t_us;    // esp_timer, 32 bits baixos: volta a cada 71 min
+    uint16_t seq;     // 16 bits baixos do índice do registro
+    uint8_t evento;
+    uint8_t nucleo;
+    uint32_t arg;
+} trace_registro_t;
+
+#if CONFIG_PLUVIO_TRACE
+#include "esp_cpu.h"
+#include "esp_timer.h"
+
+#define TRACE_REGISTROS CONFIG_PLUVIO_TRACE_REGISTROS
+
+extern trace_registro_t trace_anel[TRACE_REGISTROS];
+extern atomic_uint trace_cabeca;
+
+// Cada gravação reserva um índice com fetch_add. Enquanto o registro é escrito, seq
+// fica com um valor que não bate com nenhum índice esperado no despejo, que assim
+// descarta registros pela metade ou sobrescritos durante a cópia.
+static inline __attribute__((always_inline)) void trace_gravar(trace_evento_t evento, uint32_t arg) {
+    uint32_t i = atomic_fetch_add_explicit(&trace_cabeca, 1, memory_order_relaxed);
+    trace_registro_t *r = &trace_anel[i & (TRACE_REGISTROS - 1)];
+    r->seq = (uint16_t)(i ^ 0x8000);
+    atomic_thread_fence(memory_order_release);
+    r->t_us = (uint32_t)esp_timer_get_time();
+    r->evento = (uint8_t)evento;
+    r->nucleo = (uint8_t)esp_cpu_get_core_id();
+    r->arg = arg;
+    atomic_thread_fence(memory_order_release);
+    r->seq = (uint16_t)i;
+}
+
+#define TRACE(evento, arg) trace_gravar((evento), (uint32_t)(arg))
+
+// Recebe o despejo em pedaços
+typedef void (*trace_saida_t)(const void *dados, size_t len, void *ctx);
+
+// Escreve o cabeçalho e os registros válidos, do mais antigo ao mais novo.
+// Retorna o número de registros escritos.
+size_t trace_despejar(trace_saida_t saida, void *ctx);
+
+// Despejo em base64 na serial, entre linhas de marcação
+void trace_despejar_serial(void);
+#else
+#define TRACE(evento, arg) ((void)0)
+#endif
+
+#endif
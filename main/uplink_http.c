@@ -0,0 +1,171 @@
+#include <stdbool.h>
+#include <string.h>
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+
+#include "heap_track.h"
+#include "trace.h"
+#include "uplink_http.h"
+
+#define URL_MAX_LEN 384
+
+static const char* TAG = "UPLINK_HTTP";
+
+static esp_http_client_handle_t cliente = NULL;
+static char url[URL_MAX_LEN];
+static size_t url_base_len = 0;
+static int64_t inicio_us = 0;
+static int64_t conectado_us = 0;  // Instante do último HTTP_EVENT_ON_CONNECTED
+static uplink_http_stats_t stats;
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t lock_cpu = NULL;  // Frequência máxima só durante as requisições
+#endif
+
+// Marca o instante em que a conexão TCP foi aberta para separar conexão de requisição
+static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
+    if (evt->event_id == HTTP_EVENT_ON_CONNECTED) {
+        conectado_us = esp_timer_get_time();
+    }
+    return ESP_OK;
+}
+
+esp_err_t uplink_http_init(const char *url_base) {
+    size_t len = strlen(url_base);
+    if (len >= sizeof(url)) {
+        ESP_LOGE(TAG, "URL base muito longa (%u bytes)", (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uplink_http_close();
+#if CONFIG_PM_ENABLE
+    if (lock_cpu == NULL) {
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "uplink_http", &lock_cpu);
+    }
+#endif
+    memcpy(url, url_base, len + 1);
+    url_base_len = len;
+    return ESP_OK;
+}
+
+// Cria o cliente na primeira vez ou depois de uma falha
+static esp_err_t garantir_cliente(const char *alvo) {
+    if (cliente != NULL) {
+        return ESP_OK;
+    }
+    esp_http_client_config_t config = {
+        .url = alvo,
+        .event_handler = http_event_handler,
+        .keep_alive_enable = true,  // Sondas TCP detectam a conexão morta entre envios
+    };
+    cliente = esp_http_client_init(&config);
+    return cliente != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static esp_err_t executar(const char *alvo, esp_http_client_method_t metodo,
+                          const char *corpo, size_t len, const char *content_type) {
+    esp_err_t err = garantir_cliente(alvo);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Mesmo host: set_url mantém a conexão aberta e só troca caminho e query
+    err = esp_http_client_set_url(cliente, alvo);
+    if (err != ESP_OK) {
+        return err;
+    }
+    esp_http_client_set_method(cliente, metodo);
+    if (metodo == HTTP_METHOD_POST) {
+        esp_http_client_set_header(cliente, "Content-Type", content_type);
+        esp_http_client_set_post_field(cliente, corpo, (int)len);
+    } else {
+        esp_http_client_delete_header(cliente, "Content-Type");
+        esp_http_client_set_post_field(cliente, NULL, 0);
+    }
+
+    inicio_us = esp_timer_get_time();
+    conectado_us = 0;
+    TRACE(TRACE_HTTP_INICIO, metodo);
+    err = esp_http_client_perform(cliente);
+    int64_t fim_us = esp_timer_get_time();
+    TRACE(TRACE_HTTP_FIM, err == ESP_OK ? esp_http_client_get_status_code(cliente) : 0);
+
+    stats.requisicoes++;
+    if (conectado_us != 0) {
+        stats.conexoes++;
+        stats.ultimo_connect_us = conectado_us - inicio_us;
+        stats.ultimo_request_us = fim_us - conectado_us;
+    } else {
+        stats.ultimo_connect_us = 0;
+        stats.ultimo_request_us = fim_us - inicio_us;
+    }
+    stats.total_connect_us += stats.ultimo_connect_us;
+    stats.total_request_us += stats.ultimo_request_us;
+
+    if (err == ESP_OK) {
+        int status = esp_http_client_get_status_code(cliente);
+        if (status < 200 || status >= 300) {
+            ESP_LOGW(TAG, "Resposta HTTP %d", status);
+            err = ESP_FAIL;
+        }
+    }
+    if (err != ESP_OK) {
+        // Descarta a conexão; a próxima tentativa reconecta do zero
+        stats.falhas++;
+        uplink_http_close();
+    }
+    return err;
+}
+
+static esp_err_t requisitar(const char *alvo, esp_http_client_method_t metodo,
+                            const char *corpo, size_t len, const char *content_type) {
+    bool reaproveitando = cliente != NULL;
+    heap_sub_t marca = heap_track_entrar(HEAP_SUB_UPLINK);  // Cliente, buffers e TLS/TCP
+#if CONFIG_PM_ENABLE
+    if (lock_cpu != NULL) {
+        esp_pm_lock_acquire(lock_cpu);
+    }
+#endif
+    esp_err_t err = executar(alvo, metodo, corpo, len, content_type);
+    if (err != ESP_OK && reaproveitando) {
+        // O servidor pode ter fechado a conexão ociosa: tenta uma vez com conexão nova
+        ESP_LOGW(TAG, "Conexão reaproveitada falhou (%s), reconectando", esp_err_to_name(err));
+        err = executar(alvo, metodo, corpo, len, content_type);
+    }
+#if CONFIG_PM_ENABLE
+    if (lock_cpu != NULL) {
+        esp_pm_lock_release(lock_cpu);
+    }
+#endif
+    heap_track_sair(marca);
+
+    ESP_LOGI(TAG, "%s %s: conexão %lld ms, requisição %lld ms (%lu conexões / %lu requisições)",
+             metodo == HTTP_METHOD_POST ? "POST" : "GET", err == ESP_OK ? "ok" : "falhou",
+             stats.ultimo_connect_us / 1000, stats.ultimo_request_us / 1000,
+             (unsigned long)stats.conexoes, (unsigned long)stats.requisicoes);
+    return err;
+}
+
+esp_err_t uplink_http_get(const char *query) {
+    size_t len = strlen(query);
+    if (url_base_len + len >= sizeof(url)) {
+        ESP_LOGE(TAG, "Query muito longa (%u bytes)", (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(url + url_base_len, query, len + 1);
+    return requisitar(url, HTTP_METHOD_GET, NULL, 0, NULL);
+}
+
+esp_err_t uplink_http_post(const char *url_post, const char *corpo, size_t len, const char *content_type) {
+    return requisitar(url_post, HTTP_METHOD_POST, corpo, len, content_type);
+}
+
+void uplink_http_close(void) {
+    if (cliente != NULL) {
+        esp_http_client_cleanup(cliente);
+        cliente = NULL;
+    }
+}
+
+const uplink_http_stats_t *uplink_http_stats(void) {
+    return &stats;
+}
@@ -0,0 +1,34 @@
+#ifndef UPLINK_HTTP_H
+#define UPLINK_HTTP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Cliente HTTP persistente do envio: uma única conexão reaproveitada entre os
+// envios, reconectada só quando cai. A cada envio só a query da URL é trocada.
+typedef struct {
+    uint32_t requisicoes;
+    uint32_t conexoes;          // Quantas vezes foi preciso abrir uma conexão nova
+    uint32_t falhas;
+    int64_t ultimo_connect_us;  // 0 quando a conexão foi reaproveitada
+    int64_t ultimo_request_us;
+    int64_t total_connect_us;
+    int64_t total_request_us;
+} uplink_http_stats_t;
+
+// Define a parte fixa da URL (esquema, host, caminho e parâmetros fixos)
+esp_err_t uplink_http_init(const char *url_base);
+
+// Faz um GET com url_base seguida de query
+esp_err_t uplink_http_get(const char *query);
+
+// Faz um POST para url_post, que deve estar no mesmo host para reaproveitar a conexão
+esp_err_t uplink_http_post(const char *url_post, const char *corpo, size_t len, const char *content_type);
+
+// Encerra a conexão e libera o cliente
+void uplink_http_close(void);
+
+const uplink_http_stats_t *uplink_http_stats(void);
+
+#endif
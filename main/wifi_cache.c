@@ -0,0 +1,61 @@
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+#include "wifi_cache.h"
+
+#define WIFI_CACHE_VERSAO 1
+#define WIFI_CACHE_NAMESPACE "wifi_config"  // Apagado junto com as credenciais
+#define WIFI_CACHE_CHAVE "cache"
+
+static const char* TAG = "WIFI_CACHE";
+
+bool wifi_cache_load(wifi_cache_t *cache) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*cache);
+    esp_err_t err = nvs_get_blob(nvs_handle, WIFI_CACHE_CHAVE, cache, &len);
+    nvs_close(nvs_handle);
+    return err == ESP_OK && len == sizeof(*cache) && cache->versao == WIFI_CACHE_VERSAO;
+}
+
+esp_err_t wifi_cache_save(const wifi_cache_t *cache) {
+    wifi_cache_t atual;
+    wifi_cache_t novo = *cache;
+    novo.versao = WIFI_CACHE_VERSAO;
+    if (wifi_cache_load(&atual) && memcmp(&atual, &novo, sizeof(novo)) == 0) {
+        return ESP_OK;  // Nada mudou; poupa a flash
+    }
+
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_blob(nvs_handle, WIFI_CACHE_CHAVE, &novo, sizeof(novo));
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Cache atualizado: canal %u, BSSID %02x:%02x:%02x:%02x:%02x:%02x",
+                 novo.canal, novo.bssid[0], novo.bssid[1], novo.bssid[2],
+                 novo.bssid[3], novo.bssid[4], novo.bssid[5]);
+    } else {
+        ESP_LOGE(TAG, "Erro ao gravar o cache: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+void wifi_cache_clear(void) {
+    nvs_handle_t nvs_handle;
+    if (nvs_open(WIFI_CACHE_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        if (nvs_erase_key(nvs_handle, WIFI_CACHE_CHAVE) == ESP_OK) {
+            nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Dados da última conexão bem-sucedida, guardados na NVS junto com as credenciais
+// para que a próxima conexão pule a varredura de canais e, opcionalmente, o DHCP.
+typedef struct {
+    uint8_t versao;
+    uint8_t canal;
+    uint8_t bssid[6];
+    uint32_t ip;        // 0 = sem concessão guardada
+    uint32_t mascara;
+    uint32_t gateway;
+    uint32_t dns;
+} wifi_cache_t;
+
+// Carrega o cache; retorna false se não existir ou for de outra versão
+bool wifi_cache_load(wifi_cache_t *cache);
+
+// Grava o cache, só escrevendo na flash quando algo mudou
+esp_err_t wifi_cache_save(const wifi_cache_t *cache);
+
+// Apaga o cache (credenciais novas, rede diferente)
+void wifi_cache_clear(void);
+
+#endif
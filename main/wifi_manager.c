@@ -4,24 +4,52 @@
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "esp_event.h"
+#include "esp_random.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "esp_http_server.h"
 #include <string.h>
 #include "lwip/sockets.h"
 #include "lwip/dns.h"
 
+#include "diag.h"
+#include "heap_track.h"
+#include "trace.h"
+#include "wifi_cache.h"
 #include "wifi_manager.h"
+#include "wifi_sm.h"
 
 #define DNS_PORT 53
 #define CAPTIVE_PORTAL_IP "192.168.4.1"
 
 static const char* TAG = "WIFI_MANAGER";
-static bool connecting = false; 
 EventGroupHandle_t s_wifi_event_group;
-#define WIFI_CONNECTED_BIT BIT0
 
 #define MIN(a,b) ((a) < (b) ? (a) : (b))  // Define a macro MIN
 static bool wifi_initialized = false;  // Verifica se o WiFi foi inicializado
+static bool modo_ap = false;  // Portal de configuração ativo
+
+static esp_netif_t *sta_netif = NULL;
+static wifi_config_t sta_config;  // Credenciais, sem os dados do cache
+static wifi_caminho_t caminho = WIFI_CAMINHO_COMPLETO;  // Caminho da tentativa atual
+static int64_t inicio_conexao_us = 0;
+static wifi_tempo_ip_t tempos[WIFI_CAMINHOS];
+static const char *nomes_caminho[WIFI_CAMINHOS] = { "rápido", "completo" };
+
+// Eventos internos: os timers postam no loop de eventos padrão, então a máquina de
+// estados só é tocada pelo handler, sempre na mesma task
+ESP_EVENT_DEFINE_BASE(WIFI_SM_EVENT);
+enum {
+    WIFI_SM_EVENT_BACKOFF,   // Fim da espera entre tentativas
+    WIFI_SM_EVENT_RETOMAR,   // Fim da pausa com o rádio desligado
+};
+
+#define SM_POST_ESPERA_MS 20        // Espera por espaço na fila do loop de eventos
+#define SM_POST_RETENTATIVA_MS 100  // Com a fila ainda cheia, o timer tenta de novo
+
+static wifi_sm_t sm;
+static esp_timer_handle_t timer_backoff = NULL;
+static esp_timer_handle_t timer_pausa = NULL;
 
 void dns_server_task(void *pvParameters) {
     struct sockaddr_in server_addr, client_addr;
@@ -51,6 +79,7 @@ void dns_server_task(void *pvParameters) {
 
 // Funções locais
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
+static void postar_evento_sm(void *arg);
 void start_http_server(); 
 
 void erase_wifi_credentials() {
@@ -83,6 +112,27 @@ void initialize_wifi() {
         // Registrar o handler de eventos
         ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
         ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
+        ESP_ERROR_CHECK(esp_event_handler_register(WIFI_SM_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
+
+        const esp_timer_create_args_t backoff_args = {
+            .callback = postar_evento_sm,
+            .arg = (void *)(intptr_t)WIFI_SM_EVENT_BACKOFF,
+            .name = "wifi_backoff",
+        };
+        const esp_timer_create_args_t pausa_args = {
+            .callback = postar_evento_sm,
+            .arg = (void *)(intptr_t)WIFI_SM_EVENT_RETOMAR,
+            .name = "wifi_pausa",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&backoff_args, &timer_backoff));
+        ESP_ERROR_CHECK(esp_timer_create(&pausa_args, &timer_pausa));
+
+        const wifi_sm_config_t sm_config = {
+            .base_ms = CONFIG_PLUVIO_WIFI_BACKOFF_BASE_MS,
+            .max_ms = CONFIG_PLUVIO_WIFI_BACKOFF_MAX_MS,
+            .max_falhas = CONFIG_PLUVIO_WIFI_MAX_FALHAS,
+        };
+        wifi_sm_init(&sm, &sm_config, esp_random());
 
         wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
         ESP_ERROR_CHECK(esp_wifi_init(&cfg));
@@ -90,20 +140,99 @@ void initialize_wifi() {
     }
 }
 
-// Função para conectar/reconectar ao WiFi
-void connect_wifi() {
-    if (connecting) {
-        ESP_LOGW(TAG, "Já estamos tentando conectar, ignorando nova tentativa.");
-        return;
-    }
-
+// Função para conectar/reconectar ao WiFi. Só é chamada pela máquina de estados,
+// que garante uma tentativa por vez.
+static esp_err_t connect_wifi() {
     esp_err_t err = esp_wifi_connect();
     if (err == ESP_OK) {
-        ESP_LOGI(TAG, "Tentando conectar ao WiFi... 1");
-        connecting = true;  // Marcar que estamos conectando
+        ESP_LOGI(TAG, "Tentando conectar ao WiFi (caminho %s)... 1", nomes_caminho[caminho]);
+        inicio_conexao_us = esp_timer_get_time();
+        TRACE(TRACE_WIFI_CONECTAR, caminho);
     } else {
         ESP_LOGE(TAG, "Erro ao conectar ao WiFi: %s", esp_err_to_name(err));
     }
+    return err;
+}
+
+// Configura a próxima tentativa. O caminho rápido usa o BSSID e o canal da última
+// conexão, o que limita a varredura a um canal, e pode reusar a última concessão
+// DHCP como IP estático. O completo varre todos os canais e usa DHCP.
+static void configurar_caminho(bool rapido) {
+    wifi_config_t wifi_config = sta_config;
+
+#if CONFIG_PLUVIO_WIFI_FAST_RECONNECT
+    wifi_cache_t cache;
+    if (rapido && wifi_cache_load(&cache)) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, cache.bssid, sizeof(cache.bssid));
+        wifi_config.sta.channel = cache.canal;
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+#if CONFIG_PLUVIO_WIFI_IP_CACHE
+        if (cache.ip != 0) {
+            esp_netif_ip_info_t ip_info = {
+                .ip.addr = cache.ip,
+                .netmask.addr = cache.mascara,
+                .gw.addr = cache.gateway,
+            };
+            esp_netif_dns_info_t dns = { .ip.type = ESP_IPADDR_TYPE_V4, .ip.u_addr.ip4.addr = cache.dns };
+            esp_netif_dhcpc_stop(sta_netif);
+            esp_netif_set_ip_info(sta_netif, &ip_info);
+            esp_netif_set_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+        }
+#endif
+        caminho = WIFI_CAMINHO_RAPIDO;
+    } else
+#endif
+    {
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+        esp_netif_dhcpc_start(sta_netif);  // Já iniciado não é erro
+        caminho = WIFI_CAMINHO_COMPLETO;
+    }
+
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erro ao configurar o caminho %s: %s", nomes_caminho[caminho], esp_err_to_name(err));
+    }
+}
+
+// Guarda BSSID, canal e concessão da conexão que acabou de dar certo
+static void atualizar_cache(const esp_netif_ip_info_t *ip_info) {
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+        return;
+    }
+    wifi_cache_t cache = { 0 };
+    memcpy(cache.bssid, ap.bssid, sizeof(cache.bssid));
+    cache.canal = ap.primary;
+    cache.ip = ip_info->ip.addr;
+    cache.mascara = ip_info->netmask.addr;
+    cache.gateway = ip_info->gw.addr;
+
+    esp_netif_dns_info_t dns;
+    if (esp_netif_get_dns_info(sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK) {
+        cache.dns = dns.ip.u_addr.ip4.addr;
+    }
+    wifi_cache_save(&cache);
+}
+
+// Registra o tempo entre o esp_wifi_connect e o IP para o caminho usado
+static void registrar_tempo_ate_ip(void) {
+    wifi_tempo_ip_t *t = &tempos[caminho];
+    t->ultimo_us = esp_timer_get_time() - inicio_conexao_us;
+    t->total_us += t->ultimo_us;
+    t->conexoes++;
+    ESP_LOGI(TAG, "IP em %lld ms pelo caminho %s (média %lld ms em %lu conexões, %lu falhas)",
+             t->ultimo_us / 1000, nomes_caminho[caminho], t->total_us / 1000 / t->conexoes,
+             (unsigned long)t->conexoes, (unsigned long)t->falhas);
+}
+
+const wifi_tempo_ip_t *wifi_tempos_ate_ip(void) {
+    return tempos;
+}
+
+bool wifi_em_modo_ap(void) {
+    return modo_ap;
 }
 
 // Função para iniciar o modo STA (Station)
@@ -112,24 +241,25 @@ void start_sta_mode(const char* ssid, const char* password) {
         initialize_wifi();
     }
 
-    esp_netif_create_default_wifi_sta();
+    sta_netif = esp_netif_create_default_wifi_sta();
 
-    wifi_config_t wifi_config = { 0 };
-    strncpy((char*)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid));
-    strncpy((char*)wifi_config.sta.password, password, sizeof(wifi_config.sta.password));
+    memset(&sta_config, 0, sizeof(sta_config));
+    strncpy((char*)sta_config.sta.ssid, ssid, sizeof(sta_config.sta.ssid));
+    strncpy((char*)sta_config.sta.password, password, sizeof(sta_config.sta.password));
 
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
-
-    connect_wifi();  // Inicia a conexão WiFi
+    configurar_caminho(true);
+    ESP_ERROR_CHECK(esp_wifi_start());  // A conexão começa no WIFI_EVENT_STA_START
 }
 
 
 // Função para iniciar o modo AP (Access Point)
 void start_ap_mode() {
+    modo_ap = true;
     configure_led();  // Configura o LED
+    heap_sub_t marca = heap_track_entrar(HEAP_SUB_TASKS);  // TCB e pilha no heap
     xTaskCreate(blink_led_task, "blink_led_task", 1024, NULL, 5, NULL);  // Iniciar a task para piscar o LED
+    heap_track_sair(marca);
 
     initialize_wifi();  // Garante que o WiFi foi inicializado
 
@@ -160,36 +290,128 @@ void start_ap_mode() {
     ESP_LOGI(TAG, "Modo AP iniciado com SSID: PLUV_DIGIT_AP");
 
     // Inicia o servidor DNS para o captive portal
+    marca = heap_track_entrar(HEAP_SUB_TASKS);
     xTaskCreate(&dns_server_task, "dns_server", 4096, NULL, 5, NULL);
+    heap_track_sair(marca);
 
     // Inicia o servidor HTTP para a página de configuração
     start_http_server();
 }
 
+// Callback dos timers, na task do esp_timer (não é ISR, então pode esperar um pouco
+// pela fila do loop de eventos). Um evento perdido deixaria a máquina em ESPERANDO sem
+// nenhum timer armado: com a fila cheia, o timer é rearmado para tentar de novo.
+static void postar_evento_sm(void *arg) {
+    int32_t evento = (int32_t)(intptr_t)arg;
+    esp_err_t err = esp_event_post(WIFI_SM_EVENT, evento, NULL, 0, pdMS_TO_TICKS(SM_POST_ESPERA_MS));
+    if (err != ESP_OK) {
+        esp_timer_handle_t timer = evento == WIFI_SM_EVENT_BACKOFF ? timer_backoff : timer_pausa;
+        ESP_LOGW(TAG, "Evento %ld da máquina WiFi não postado (%s); nova tentativa em %d ms",
+                 (long)evento, esp_err_to_name(err), SM_POST_RETENTATIVA_MS);
+        esp_timer_start_once(timer, SM_POST_RETENTATIVA_MS * 1000ULL);
+    }
+}
+
+// Reflete o estado da máquina no grupo de eventos: um bit por estado, nenhum no ocioso
+static void publicar_estado(wifi_sm_estado_t anterior) {
+    if (sm.estado != anterior) {
+        ESP_LOGI(TAG, "Estado WiFi: %s -> %s (%lu falhas)", wifi_sm_nome_estado(anterior),
+                 wifi_sm_nome_estado(sm.estado), (unsigned long)sm.falhas);
+    }
+    if (s_wifi_event_group == NULL) {
+        return;
+    }
+    EventBits_t bits = 0;
+    switch (sm.estado) {
+    case WIFI_SM_CONECTANDO: bits = WIFI_CONECTANDO_BIT; break;
+    case WIFI_SM_CONECTADO: bits = WIFI_CONNECTED_BIT; break;
+    case WIFI_SM_ESPERANDO: bits = WIFI_ESPERANDO_BIT; break;
+    case WIFI_SM_DESISTIU: bits = WIFI_DESISTIU_BIT; break;
+    default: break;
+    }
+    xEventGroupClearBits(s_wifi_event_group, WIFI_ESTADO_BITS & ~bits);
+    xEventGroupSetBits(s_wifi_event_group, bits);
+}
+
+// Depois de CONFIG_PLUVIO_WIFI_MAX_FALHAS falhas seguidas: abre o portal de
+// configuração ou desliga o rádio por CONFIG_PLUVIO_WIFI_PAUSA_S e tenta de novo
+static void desistir(void) {
+#if CONFIG_PLUVIO_WIFI_DESISTIR_AP
+    ESP_LOGW(TAG, "AP indisponível; abrindo o portal de configuração");
+    start_ap_mode();
+#else
+    ESP_LOGW(TAG, "AP indisponível; rádio desligado por %d s", CONFIG_PLUVIO_WIFI_PAUSA_S);
+    esp_wifi_stop();
+    esp_timer_start_once(timer_pausa, CONFIG_PLUVIO_WIFI_PAUSA_S * 1000000ULL);
+#endif
+}
+
+static void processar_evento_sm(wifi_sm_evento_t evento) {
+    wifi_sm_estado_t anterior = sm.estado;
+    wifi_sm_acao_t acao = wifi_sm_evento(&sm, evento);
+    publicar_estado(anterior);
+
+    switch (acao) {
+    case WIFI_SM_ACAO_CONECTAR:
+        if (connect_wifi() != ESP_OK) {
+            processar_evento_sm(WIFI_SM_EV_DESCONECTOU);  // Conta como falha e entra no backoff
+        }
+        break;
+    case WIFI_SM_ACAO_AGENDAR:
+        ESP_LOGI(TAG, "Nova tentativa em %lu ms", (unsigned long)sm.espera_ms);
+        esp_timer_start_once(timer_backoff, sm.espera_ms * 1000ULL);
+        break;
+    case WIFI_SM_ACAO_DESISTIR:
+        desistir();
+        break;
+    case WIFI_SM_ACAO_NENHUMA:
+        break;
+    }
+}
+
 // Função de gerenciamento de eventos WiFi
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
     if (event_base == WIFI_EVENT) {
         if (event_id == WIFI_EVENT_STA_START) {
             ESP_LOGI(TAG, "Iniciando conexão WiFi...");
-            connect_wifi();  // Tenta conectar
+            processar_evento_sm(WIFI_SM_EV_INICIAR);
         } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
             ESP_LOGI(TAG, "WiFi desconectado. Tentando reconectar... 2");
-            connecting = false;  // Permite nova tentativa de conexão
-            connect_wifi();  // Tenta reconectar
+            TRACE(TRACE_WIFI_QUEDA, ((wifi_event_sta_disconnected_t *)event_data)->reason);
+            bool tinha_ip = sm.estado == WIFI_SM_CONECTADO;
+            if (sta_netif != NULL && (tinha_ip || sm.estado == WIFI_SM_CONECTANDO)) {
+                if (!tinha_ip && caminho == WIFI_CAMINHO_RAPIDO) {
+                    // BSSID ou canal mudaram, ou a concessão não vale mais
+                    tempos[WIFI_CAMINHO_RAPIDO].falhas++;
+                    ESP_LOGW(TAG, "Caminho rápido falhou; voltando à varredura completa");
+                    configurar_caminho(false);
+                } else if (tinha_ip) {
+                    configurar_caminho(true);
+                } else {
+                    tempos[WIFI_CAMINHO_COMPLETO].falhas++;
+                }
+            }
+            processar_evento_sm(WIFI_SM_EV_DESCONECTOU);  // O envio passa a guardar as leituras
             led_off();  // Desliga o LED se perder a conexão
         }
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
+        TRACE(TRACE_WIFI_IP, caminho);
         ESP_LOGI(TAG, "Conectado ao WiFi. Endereço IP: " IPSTR, IP2STR(&event->ip_info.ip));
         led_on();  // Liga o LED após a conexão bem-sucedida
-        connecting = false;  // Conexão bem-sucedida, resetar a flag
+        registrar_tempo_ate_ip();
+        atualizar_cache(&event->ip_info);
 
-        // Verifique se o EventGroup foi criado antes de definir o bit
-        if (s_wifi_event_group != NULL) {
-            xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-        } else {
+        if (s_wifi_event_group == NULL) {
             ESP_LOGE(TAG, "EventGroup não foi criado!");
         }
+        processar_evento_sm(WIFI_SM_EV_CONECTOU);
+    } else if (event_base == WIFI_SM_EVENT && event_id == WIFI_SM_EVENT_BACKOFF) {
+        processar_evento_sm(WIFI_SM_EV_TIMER);
+    } else if (event_base == WIFI_SM_EVENT && event_id == WIFI_SM_EVENT_RETOMAR) {
+        ESP_LOGI(TAG, "Fim da pausa; religando o rádio");
+        configurar_caminho(true);
+        esp_wifi_start();  // O WIFI_EVENT_STA_START reinicia a máquina de estados
     } else {
         ESP_LOGW(TAG, "Evento inesperado: base=%s, id=%ld", event_base, (long int)event_id);
     }
@@ -304,6 +526,7 @@ void save_wifi_credentials(const char* ssid, const char* password) {
     }
 
     nvs_close(nvs_handle);
+    wifi_cache_clear();  // Rede nova: BSSID, canal e concessão guardados não valem mais
 }
 
 
@@ -363,6 +586,37 @@ esp_err_t post_handler(httpd_req_t *req) {
 
 
 
+// Último resumo do diagnóstico das tasks, o mesmo enviado no status
+esp_err_t diag_handler(httpd_req_t *req) {
+    char status[DIAG_STATUS_MAX];
+    diag_ultimo(status, sizeof(status));
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_send(req, status, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+#if CONFIG_PLUVIO_TRACE
+static void enviar_pedaco(const void *dados, size_t len, void *ctx) {
+    httpd_resp_send_chunk((httpd_req_t *)ctx, dados, len);
+}
+
+// Despejo binário do anel de rastreamento, para o tools/trace_decode.py
+esp_err_t trace_handler(httpd_req_t *req) {
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+    trace_despejar(enviar_pedaco, req);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+httpd_uri_t uri_trace = {
+    .uri       = "/trace",
+    .method    = HTTP_GET,
+    .handler   = trace_handler,
+    .user_ctx  = NULL
+};
+#endif
+
 httpd_uri_t uri_get = {
     .uri       = "/",
     .method    = HTTP_GET,
@@ -377,6 +631,13 @@ httpd_uri_t uri_post = {
     .user_ctx  = NULL
 };
 
+httpd_uri_t uri_diag = {
+    .uri       = "/diag",
+    .method    = HTTP_GET,
+    .handler   = diag_handler,
+    .user_ctx  = NULL
+};
+
 // Função para iniciar o servidor HTTP
 void start_http_server() {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
@@ -386,6 +647,10 @@ void start_http_server() {
         // Página de configuração
         httpd_register_uri_handler(server, &uri_get);
         httpd_register_uri_handler(server, &uri_post);
+        httpd_register_uri_handler(server, &uri_diag);
+#if CONFIG_PLUVIO_TRACE
+        httpd_register_uri_handler(server, &uri_trace);
+#endif
         
         // Redirecionar todas as outras requisições para a página de configuração
         httpd_uri_t uri_redirect = {
@@ -1,10 +1,31 @@
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
+// Estado da conexão no grupo de eventos: no máximo um destes bits fica ligado
 #define WIFI_CONNECTED_BIT BIT0
+#define WIFI_CONECTANDO_BIT BIT1
+#define WIFI_ESPERANDO_BIT BIT2   // Aguardando o backoff entre tentativas
+#define WIFI_DESISTIU_BIT BIT3    // Falhas demais; em modo AP ou com o rádio em pausa
+#define WIFI_ESTADO_BITS (WIFI_CONNECTED_BIT | WIFI_CONECTANDO_BIT | WIFI_ESPERANDO_BIT | WIFI_DESISTIU_BIT)
 extern EventGroupHandle_t s_wifi_event_group;
 
 #include <stdbool.h>
+#include <stdint.h>
+
+// Caminhos de conexão: pelo cache da última conexão ou com varredura completa
+typedef enum {
+    WIFI_CAMINHO_RAPIDO,
+    WIFI_CAMINHO_COMPLETO,
+    WIFI_CAMINHOS
+} wifi_caminho_t;
+
+// Tempo até obter IP, por caminho
+typedef struct {
+    uint32_t conexoes;
+    uint32_t falhas;
+    int64_t ultimo_us;
+    int64_t total_us;
+} wifi_tempo_ip_t;
 
 void start_wifi_configuration(bool credentials_exist, const char* ssid, const char* password);
 void start_sta_mode(const char* ssid, const char* password);
@@ -13,6 +34,12 @@ bool wifi_credentials_exist();
 void save_wifi_credentials(const char* ssid, const char* password);
 void erase_wifi_credentials();
 
+// Estatísticas de tempo até IP, indexadas por wifi_caminho_t
+const wifi_tempo_ip_t *wifi_tempos_ate_ip(void);
+
+// true enquanto o portal de configuração (modo AP) estiver ativo
+bool wifi_em_modo_ap(void);
+
 // Declaração das funções relacionadas ao LED
 void configure_led(void);  // Configuração do LED
 void blink_led_task(void *pvParameter);  // Task para piscar o LED
@@ -0,0 +1,21 @@
+# SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+#
+# Teste de fumaça na placa: o firmware sobe e a task do sensor inicializa um dos
+# contadores de basculadas. A lógica em si é testada no host, sem placa, em
+# components/pluvio_core/host_test.
+
+from typing import Callable
+
+import pytest
+from pytest_embedded import Dut
+
+
+@pytest.mark.esp32
+@pytest.mark.generic
+def test_pluviometro_inicializa(
+    dut: Dut, log_minimum_free_heap_size: Callable[..., None]
+) -> None:
+    log_minimum_free_heap_size()
+    backend = dut.expect(r"Sensor inicializado \(contador '(\w+)'\)").group(1).decode()
+    assert backend in ('pcnt', 'isr', 'poll', 'ulp')
@@ -0,0 +1,195 @@
+# SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+#
+# Teste de ponta a ponta no QEMU do esp32: o firmware inteiro (app_main, tasks, filtro,
+# agregação, envio HTTP) sem placa nem pluviômetro. O firmware do modo de teste
+# (CONFIG_PLUVIO_QEMU, ver sdkconfig.ci.qemu) troca o WiFi pela Ethernet emulada e
+# aceita pelo console comandos que injetam basculadas no backend ISR, e o envio vai
+# para um ThingSpeak falso servido por este teste em 127.0.0.1:18080.
+#
+# Para cada ritmo de basculadas o teste mede:
+#  - injetadas, aceitas pelo filtro e contadas na nuvem (o field6, chuva em 24 h,
+#    dividido pela calibração);
+#  - a latência de cada envio (conexão e requisição, do log do UPLINK_HTTP) e da
+#    última basculada até o envio que a contém chegar ao servidor;
+#  - o menor heap livre (campo status do diagnóstico e comando heap).
+# Os números vão para o relatório JUnit (record_property) e para a saída do pytest.
+#
+#   idf.py -B build_esp32_qemu -D SDKCONFIG=build_esp32_qemu/sdkconfig \
+#          -D SDKCONFIG_DEFAULTS="sdkconfig;sdkconfig.ci.qemu" build
+#   pytest pytest_qemu_pluviometro.py --target esp32 --build-dir build_esp32_qemu -s
+
+import re
+import statistics
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Callable, Dict, Iterator, List, Optional
+from urllib.parse import parse_qs, urlparse
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+
+PORTA = 18080  # A mesma do CONFIG_PLUVIO_THINGSPEAK_URL do sdkconfig.ci.qemu
+
+# (basculadas, período em ms, largura do pulso em ms). O filtro aceita no máximo
+# CONFIG_PLUVIO_DEBOUNCE_TAXA_MAX_POR_MIN (120/min, uma a cada 500 ms): os dois
+# primeiros ritmos estão dentro do limite e precisam ser contados inteiros; o último
+# passa dele e mede quanto o filtro rejeita.
+RITMOS = [
+    (20, 1000, 50),
+    (40, 600, 30),
+    (40, 250, 30),
+]
+
+
+class ThingSpeakFalso:
+    """Responde como o api.thingspeak.com e guarda o que chegou, com o instante."""
+
+    def __init__(self, porta: int) -> None:
+        self.envios: List[Dict] = []
+        self.lock = threading.Condition()
+        falso = self
+
+        class Handler(BaseHTTPRequestHandler):
+            protocol_version = 'HTTP/1.1'  # Keep-alive, como o uplink espera
+
+            def responder(self, status: int, corpo: bytes) -> None:
+                self.send_response(status)
+                self.send_header('Content-Length', str(len(corpo)))
+                self.end_headers()
+                self.wfile.write(corpo)
+
+            def do_GET(self) -> None:
+                url = urlparse(self.path)
+                if url.path != '/update':
+                    self.responder(404, b'0')
+                    return
+                campos = {k: v[0] for k, v in parse_qs(url.query).items()}
+                with falso.lock:
+                    falso.envios.append({'t': time.monotonic(), 'campos': campos})
+                    n = len(falso.envios)
+                    falso.lock.notify_all()
+                self.responder(200, str(n).encode())
+
+            def do_POST(self) -> None:
+                self.rfile.read(int(self.headers.get('Content-Length', 0)))
+                self.responder(202, b'{"success":true}')
+
+            def log_message(self, *args: object) -> None:
+                pass
+
+        self.servidor = ThreadingHTTPServer(('127.0.0.1', porta), Handler)
+        self.thread = threading.Thread(target=self.servidor.serve_forever, daemon=True)
+        self.thread.start()
+
+    def fechar(self) -> None:
+        self.servidor.shutdown()
+        self.servidor.server_close()
+
+    def proximo_apos(self, t: float, timeout: float) -> Dict:
+        """Primeiro envio que chegou depois do instante t (time.monotonic)."""
+        limite = time.monotonic() + timeout
+        with self.lock:
+            while True:
+                for envio in self.envios:
+                    if envio['t'] > t:
+                        return envio
+                restante = limite - time.monotonic()
+                if restante <= 0:
+                    raise TimeoutError(f'nenhum envio em {timeout:.0f} s')
+                self.lock.wait(restante)
+
+
+def basculadas_24h(envio: Dict, mm_por_basculada: float) -> int:
+    return round(float(envio['campos'].get('field6', 0)) / mm_por_basculada)
+
+
+def heap_minimo(envios: List[Dict]) -> Optional[int]:
+    valores = []
+    for envio in envios:
+        m = re.search(r'heap:(\d+)/(\d+)', envio['campos'].get('status', ''))
+        if m:
+            valores.append(int(m.group(1)))
+    return min(valores) if valores else None
+
+
+def latencias_uplink(log: str) -> List[int]:
+    # "UPLINK_HTTP: GET ok: conexão 12 ms, requisição 34 ms (...)"
+    return [int(c) + int(r) for c, r in re.findall(r'UPLINK_HTTP: GET ok: \S+ (\d+) ms, \S+ (\d+) ms', log)]
+
+
+@pytest.fixture
+def thingspeak() -> Iterator[ThingSpeakFalso]:
+    falso = ThingSpeakFalso(PORTA)
+    yield falso
+    falso.fechar()
+
+
+@pytest.mark.esp32
+@pytest.mark.qemu
+@pytest.mark.parametrize('embedded_services, qemu_extra_args', [
+    ('idf,qemu', '-nic user,model=open_eth'),
+], indirect=True)
+def test_pluviometro_qemu(dut: IdfDut, thingspeak: ThingSpeakFalso,
+                          record_property: Callable[[str, object], None]) -> None:
+    mm_por_basculada = int(dut.app.sdkconfig.get('PLUVIO_UM_POR_BASCULADA', 1630)) / 1000
+
+    dut.expect_exact('PLUVQEMU pronto', timeout=30)
+    dut.expect(r'PLUVQEMU ip \d+\.\d+\.\d+\.\d+', timeout=60)
+    dut.expect(r"Sensor inicializado \(contador 'isr'\)", timeout=30)
+
+    # Linha de base: o primeiro envio, antes de qualquer basculada
+    anterior = thingspeak.proximo_apos(0, timeout=120)
+    resultados = []
+    for n, periodo_ms, largura_ms in RITMOS:
+        dut.write(f'pulsos {n} {periodo_ms} {largura_ms}')
+        m = dut.expect(r'PLUVQEMU pulsos injetadas=(\d+) aceitas=(\d+) duracao_ms=(\d+)',
+                       timeout=n * periodo_ms / 1000 + 30)
+        fim = time.monotonic()
+        aceitas = int(m.group(2))
+
+        # O envio seguinte ao fim da injeção já mede todas as basculadas
+        envio = thingspeak.proximo_apos(fim, timeout=120)
+        contadas = basculadas_24h(envio, mm_por_basculada) - basculadas_24h(anterior, mm_por_basculada)
+        anterior = envio
+
+        ritmo = 60000 / periodo_ms
+        resultado = {
+            'ritmo_por_min': ritmo,
+            'injetadas': n,
+            'aceitas': aceitas,
+            'contadas': contadas,
+            'ate_nuvem_s': envio['t'] - fim,
+        }
+        resultados.append(resultado)
+        print(f'{ritmo:6.0f}/min: {n} injetadas, {aceitas} aceitas pelo filtro, {contadas} contadas na nuvem, '
+              f'envio {resultado["ate_nuvem_s"]:.1f} s após a última')
+        for chave, valor in resultado.items():
+            record_property(f'{ritmo:.0f}_por_min_{chave}', valor)
+
+    dut.write('heap')
+    m = dut.expect(r'PLUVQEMU heap livre=(\d+) livre_minimo=(\d+) maior_bloco=(\d+)', timeout=10)
+    livre_minimo, maior_bloco = int(m.group(2)), int(m.group(3))
+    with open(dut.logfile, errors='replace') as f:
+        latencias = latencias_uplink(f.read())
+
+    print(f'{len(thingspeak.envios)} envios; heap livre mínimo {livre_minimo} B '
+          f'(status: {heap_minimo(thingspeak.envios)} B), maior bloco {maior_bloco} B')
+    record_property('envios', len(thingspeak.envios))
+    record_property('heap_livre_minimo', livre_minimo)
+    record_property('heap_maior_bloco', maior_bloco)
+    if latencias:
+        print(f'Envio HTTP: mediana {statistics.median(latencias)} ms, máximo {max(latencias)} ms')
+        record_property('envio_mediana_ms', statistics.median(latencias))
+        record_property('envio_max_ms', max(latencias))
+
+    # Nada se perde depois do filtro, e dentro do limite do filtro (com folga para o
+    # tick do FreeRTOS) nada é rejeitado
+    taxa_max = int(dut.app.sdkconfig.get('PLUVIO_DEBOUNCE_TAXA_MAX_POR_MIN', 120))
+    intervalo_min_ms = 60000 / taxa_max if taxa_max else 0
+    for (n, periodo_ms, _), r in zip(RITMOS, resultados):
+        assert r['contadas'] == r['aceitas'], r
+        if periodo_ms >= intervalo_min_ms + 100:
+            assert r['aceitas'] == n, r
+    assert latencias, 'nenhum envio HTTP bem-sucedido no log'
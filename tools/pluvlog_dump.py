@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Lê uma cópia da partição pluvlog e lista as leituras guardadas durante a falta de WiFi.
+#
+# Para extrair a partição do dispositivo:
+#   parttool.py --port /dev/ttyUSB0 read_partition --partition-name pluvlog --output pluvlog.bin
+#
+# O formato é o de main/offline_log.c e o registro é o leitura_t de components/pluvio_core/include/leitura.h.
+
+import argparse
+import datetime
+import struct
+import sys
+import zlib
+
+SETOR_TAM = 4096
+CAB_SETOR = struct.Struct('<IIII')  # magic, seq, tam_slot, reservado
+LOG_MAGIC = 0x474F4C50
+LOG_COMMIT = 0x54494D43
+APAGADO = 0xFFFFFFFF
+
+LEITURA = struct.Struct('<IIHH6f')  # epoch_s, uptime_s, boot, basculadas, field1..field6
+
+
+def ler_setores(dados):
+    setores = []
+    for i in range(len(dados) // SETOR_TAM):
+        base = i * SETOR_TAM
+        magic, seq, tam_slot, _ = CAB_SETOR.unpack_from(dados, base)
+        if magic == LOG_MAGIC:
+            setores.append((seq, i, tam_slot))
+    return sorted(setores)  # do mais antigo para o mais novo
+
+
+def ler_slots(dados, setor, tam_slot):
+    tam_dados = tam_slot - 16
+    base = setor * SETOR_TAM + CAB_SETOR.size
+    for slot in range((SETOR_TAM - CAB_SETOR.size) // tam_slot):
+        bruto = dados[base + slot * tam_slot: base + (slot + 1) * tam_slot]
+        if bruto == b'\xff' * tam_slot:
+            return
+        crc, seq = struct.unpack_from('<II', bruto, 0)
+        commit, enviado = struct.unpack_from('<II', bruto, 8 + tam_dados)
+        if commit != LOG_COMMIT or crc != zlib.crc32(bruto[4:8 + tam_dados]):
+            yield seq, 'inválido', None
+            continue
+        estado = 'pendente' if enviado == APAGADO else 'enviado'
+        yield seq, estado, bruto[8:8 + tam_dados]
+
+
+def formatar(leitura):
+    epoch, uptime, boot, basculadas, *campos = LEITURA.unpack_from(leitura)
+    quando = (datetime.datetime.fromtimestamp(epoch, datetime.timezone.utc).isoformat()
+              if epoch else f'boot {boot} + {uptime} s')
+    valores = ' '.join(f'{v:.2f}' for v in campos)
+    return f'{quando:>32}  basculadas={basculadas:<5} campos={valores}'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Lista as leituras guardadas na partição pluvlog')
+    parser.add_argument('imagem', help='cópia binária da partição pluvlog')
+    parser.add_argument('--todos', action='store_true', help='lista também os registros já enviados e inválidos')
+    args = parser.parse_args()
+
+    with open(args.imagem, 'rb') as f:
+        dados = f.read()
+
+    contagem = {'pendente': 0, 'enviado': 0, 'inválido': 0}
+    for seq_setor, setor, tam_slot in ler_setores(dados):
+        for seq, estado, leitura in ler_slots(dados, setor, tam_slot):
+            contagem[estado] += 1
+            if estado == 'pendente' or args.todos:
+                detalhe = formatar(leitura) if leitura else ''
+                print(f'setor {setor:3} #{seq:<8} {estado:9} {detalhe}')
+
+    print(f'{contagem["pendente"]} pendentes, {contagem["enviado"]} enviados, '
+          f'{contagem["inválido"]} inválidos', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
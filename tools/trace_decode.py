@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+# Decodifica o despejo do anel de rastreamento (main/trace.c) e mostra histogramas
+# de latência dos caminhos críticos.
+#
+# Aceita o binário baixado do portal:
+#   curl -o trace.bin http://192.168.4.1/trace
+# ou um log da serial com os blocos ==PLUVTRACE INICIO== ... ==PLUVTRACE FIM==
+# (usa o último bloco do log, ou o escolhido com --despejo):
+#   idf.py monitor | tee serial.log
+#
+# O formato é o de main/trace.h: cabeçalho de 16 bytes e registros de 12 bytes.
+
+import argparse
+import base64
+import struct
+import sys
+
+CABECALHO = struct.Struct('<IBBHII')  # magic, versão, tam_registro, capacidade, cabeça, agora_us
+REGISTRO = struct.Struct('<IHBBI')    # t_us, seq, evento, núcleo, arg
+TRACE_MAGIC = 0x43525450
+MARCA_INICIO = '==PLUVTRACE INICIO=='
+MARCA_FIM = '==PLUVTRACE FIM=='
+
+BORDA, BASCULADA, AGREGADO, DESPERTAR, ENVIO_INICIO, ENVIO_FIM, \
+    HTTP_INICIO, HTTP_FIM, WIFI_CONECTAR, WIFI_IP, WIFI_QUEDA = range(1, 12)
+
+NOMES = {
+    BORDA: 'borda', BASCULADA: 'basculada', AGREGADO: 'agregado', DESPERTAR: 'despertar',
+    ENVIO_INICIO: 'envio_inicio', ENVIO_FIM: 'envio_fim', HTTP_INICIO: 'http_inicio',
+    HTTP_FIM: 'http_fim', WIFI_CONECTAR: 'wifi_conectar', WIFI_IP: 'wifi_ip', WIFI_QUEDA: 'wifi_queda',
+}
+DESPERTARES = {0: 'prazo', 1: 'basculada', 2: 'sono'}
+
+
+def extrair_da_serial(texto, indice):
+    blocos = []
+    atual = None
+    for linha in texto.splitlines():
+        linha = linha.strip()
+        if linha.startswith(MARCA_INICIO):
+            atual = []
+        elif linha.startswith(MARCA_FIM) and atual is not None:
+            blocos.append(base64.b64decode(''.join(atual)))
+            atual = None
+        elif atual is not None and linha:
+            atual.append(linha)
+    if not blocos:
+        sys.exit('nenhum bloco ==PLUVTRACE== no log')
+    return blocos[indice]
+
+
+def ler_registros(dados):
+    magic, versao, tam, capacidade, cabeca, agora = CABECALHO.unpack_from(dados)
+    if magic != TRACE_MAGIC or versao != 1 or tam != REGISTRO.size:
+        sys.exit(f'despejo inválido (magic {magic:#x}, versão {versao}, registro {tam} bytes)')
+    registros = [REGISTRO.unpack_from(dados, off)
+                 for off in range(CABECALHO.size, len(dados) - REGISTRO.size + 1, REGISTRO.size)]
+    perdidos = max(0, cabeca - capacidade)
+    return registros, perdidos, capacidade, cabeca
+
+
+def desdobrar(registros):
+    # t_us tem 32 bits: a cada volta (71 min) soma 2^32. Registros de núcleos
+    # diferentes podem vir levemente fora de ordem, o que não conta como volta.
+    base = 0
+    anterior = None
+    eventos = []
+    for t, seq, evento, nucleo, arg in registros:
+        if anterior is not None and t < anterior and anterior - t > 1 << 31:
+            base += 1 << 32
+        anterior = t
+        eventos.append((base + t, evento, nucleo, arg))
+    return eventos
+
+
+def latencias(eventos):
+    series = {
+        'borda -> basculada contada': [],
+        'basculada -> agregada no envio': [],
+        'despertar -> envio concluído': [],
+        'esp_http_client_perform': [],
+        'esp_wifi_connect -> IP': [],
+    }
+    pendentes_agregar = []
+    despertar = http = wifi = None
+    for t, evento, _, arg in eventos:
+        if evento == BASCULADA:
+            # arg é o instante da borda, no mesmo relógio de 32 bits
+            series['borda -> basculada contada'].append((t - arg) & 0xFFFFFFFF)
+            pendentes_agregar.append(t)
+        elif evento == AGREGADO:
+            series['basculada -> agregada no envio'].extend(t - b for b in pendentes_agregar)
+            pendentes_agregar = []
+        elif evento == DESPERTAR:
+            despertar = t
+        elif evento == ENVIO_FIM and despertar is not None:
+            series['despertar -> envio concluído'].append(t - despertar)
+            despertar = None
+        elif evento == HTTP_INICIO:
+            http = t
+        elif evento == HTTP_FIM and http is not None:
+            series['esp_http_client_perform'].append(t - http)
+            http = None
+        elif evento == WIFI_CONECTAR:
+            wifi = t
+        elif evento == WIFI_IP and wifi is not None:
+            series['esp_wifi_connect -> IP'].append(t - wifi)
+            wifi = None
+    return series
+
+
+def formatar_us(us):
+    if us >= 1000000:
+        return f'{us / 1e6:.2f} s'
+    if us >= 1000:
+        return f'{us / 1e3:.1f} ms'
+    return f'{us} us'
+
+
+def percentil(ordenados, p):
+    return ordenados[min(len(ordenados) - 1, int(p / 100 * len(ordenados)))]
+
+
+def histograma(nome, valores, largura=40):
+    print(f'\n{nome}: {len(valores)} amostras')
+    if not valores:
+        return
+    v = sorted(valores)
+    print(f'  mín {formatar_us(v[0])}  p50 {formatar_us(percentil(v, 50))}  '
+          f'p90 {formatar_us(percentil(v, 90))}  p99 {formatar_us(percentil(v, 99))}  máx {formatar_us(v[-1])}')
+    # Faixas em potências de 2 de microssegundos
+    faixas = {}
+    for x in v:
+        bits = max(0, x).bit_length()
+        faixas[bits] = faixas.get(bits, 0) + 1
+    maior = max(faixas.values())
+    for bits in range(min(faixas), max(faixas) + 1):
+        n = faixas.get(bits, 0)
+        inicio = 0 if bits == 0 else 1 << (bits - 1)
+        fim = (1 << bits) - 1 if bits > 0 else 0
+        barra = '#' * max(1 if n else 0, n * largura // maior)
+        print(f'  {formatar_us(inicio):>10} .. {formatar_us(fim):>10} | {n:6} {barra}')
+
+
+def listar(eventos):
+    inicio = eventos[0][0] if eventos else 0
+    for t, evento, nucleo, arg in eventos:
+        detalhe = DESPERTARES.get(arg, arg) if evento == DESPERTAR else arg
+        print(f'{(t - inicio) / 1e6:12.6f} s  núcleo {nucleo}  {NOMES.get(evento, evento):14} {detalhe}')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Histogramas de latência do anel de rastreamento')
+    parser.add_argument('arquivo', help='trace.bin do portal ou log da serial')
+    parser.add_argument('--despejo', type=int, default=-1,
+                        help='qual bloco do log da serial usar (padrão: o último)')
+    parser.add_argument('--lista', action='store_true', help='lista também os eventos')
+    args = parser.parse_args()
+
+    with open(args.arquivo, 'rb') as f:
+        dados = f.read()
+    if not dados.startswith(struct.pack('<I', TRACE_MAGIC)):
+        dados = extrair_da_serial(dados.decode('utf-8', errors='replace'), args.despejo)
+
+    registros, perdidos, capacidade, cabeca = ler_registros(dados)
+    eventos = desdobrar(registros)
+    print(f'{len(registros)} registros de {cabeca} gravados (anel de {capacidade}; '
+          f'{perdidos} sobrescritos, {cabeca - perdidos - len(registros)} descartados no despejo)')
+
+    if args.lista:
+        listar(eventos)
+    for nome, valores in latencias(eventos).items():
+        histograma(nome, valores)
+
+
+if __name__ == '__main__':
+    main()
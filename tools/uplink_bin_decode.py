@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# Decodifica o corpo do envio binário (CONFIG_PLUVIO_UPLINK_BINARIO) e lista as leituras.
+#
+# O formato é o de components/pluvio_core/include/uplink_bin.h. Para guardar o que o
+# dispositivo manda, um servidor só precisa gravar o corpo de cada POST num arquivo:
+#   uplink_bin_decode.py corpo.bin
+#   uplink_bin_decode.py --json corpo.bin    # Objeto com os nomes do ThingSpeak
+#
+# decodificar() pode ser importada pelo servidor que recebe os envios.
+
+import argparse
+import datetime
+import json
+import sys
+
+VERSAO = 1
+CAMPOS = 6
+
+
+class FormatoInvalido(ValueError):
+    pass
+
+
+class Leitor:
+    def __init__(self, dados):
+        self.dados = dados
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.dados):
+            raise FormatoInvalido(f'dados truncados no byte {self.pos}')
+        b = self.dados[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        v = 0
+        for deslocamento in range(0, 35, 7):
+            b = self.byte()
+            v |= (b & 0x7F) << deslocamento
+            if not b & 0x80:
+                return v & 0xFFFFFFFF
+        raise FormatoInvalido(f'varint longo demais no byte {self.pos}')
+
+    def zigzag(self):
+        v = self.varint()
+        return (v >> 1) ^ -(v & 1)
+
+    def texto(self):
+        n = self.byte()
+        if self.pos + n > len(self.dados):
+            raise FormatoInvalido(f'texto truncado no byte {self.pos}')
+        t = self.dados[self.pos:self.pos + n].decode('utf-8', errors='replace')
+        self.pos += n
+        return t
+
+
+def decodificar(dados):
+    """Retorna {'chave', 'status', 'leituras': [{'epoch', 'basculadas', 'campos'}]}."""
+    if len(dados) < 4 or dados[:2] != b'PL':
+        raise FormatoInvalido('não é um envio binário do pluviômetro')
+    if dados[2] != VERSAO:
+        raise FormatoInvalido(f'versão {dados[2]} desconhecida (esperada {VERSAO})')
+    n = dados[3]
+    leitor = Leitor(dados)
+    leitor.pos = 4
+    chave = leitor.texto()
+
+    leituras = []
+    epoch = 0
+    for _ in range(n):
+        epoch = (epoch + leitor.zigzag()) & 0xFFFFFFFF
+        basculadas = leitor.varint()
+        campos = [leitor.zigzag() / 100 for _ in range(CAMPOS)]
+        leituras.append({'epoch': epoch, 'basculadas': basculadas, 'campos': campos})
+    status = leitor.texto()
+    if leitor.pos != len(dados):
+        raise FormatoInvalido(f'{len(dados) - leitor.pos} bytes sobrando no fim')
+    return {'chave': chave, 'status': status, 'leituras': leituras}
+
+
+def para_thingspeak(envio):
+    """O mesmo envio no formato do bulk_update.json do ThingSpeak."""
+    updates = []
+    for i, leitura in enumerate(envio['leituras']):
+        update = {}
+        if leitura['epoch']:
+            quando = datetime.datetime.fromtimestamp(leitura['epoch'], datetime.timezone.utc)
+            update['created_at'] = quando.strftime('%Y-%m-%dT%H:%M:%SZ')
+        for c, valor in enumerate(leitura['campos']):
+            update[f'field{c + 1}'] = round(valor, 2)
+        if i == len(envio['leituras']) - 1 and envio['status']:
+            update['status'] = envio['status']
+        updates.append(update)
+    return {'write_api_key': envio['chave'], 'updates': updates}
+
+
+def formatar(leitura):
+    quando = (datetime.datetime.fromtimestamp(leitura['epoch'], datetime.timezone.utc).isoformat()
+              if leitura['epoch'] else 'horário da chegada')
+    valores = ' '.join(f'{v:.2f}' for v in leitura['campos'])
+    return f'{quando:>25}  basculadas={leitura["basculadas"]:<5} campos={valores}'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodifica o corpo do envio binário do pluviômetro')
+    parser.add_argument('arquivo', nargs='?', help='corpo de um POST; sem ele, lê a entrada padrão')
+    parser.add_argument('--json', action='store_true', help='imprime no formato do bulk_update do ThingSpeak')
+    args = parser.parse_args()
+
+    if args.arquivo:
+        with open(args.arquivo, 'rb') as f:
+            dados = f.read()
+    else:
+        dados = sys.stdin.buffer.read()
+
+    try:
+        envio = decodificar(dados)
+    except FormatoInvalido as e:
+        print(f'erro: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    if args.json:
+        print(json.dumps(para_thingspeak(envio), indent=2))
+        return
+    for leitura in envio['leituras']:
+        print(formatar(leitura))
+    print(f'{len(envio["leituras"])} leituras em {len(dados)} bytes; status: {envio["status"] or "-"}',
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()